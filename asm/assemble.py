@@ -12,6 +12,7 @@ import sys
 import subprocess
 
 from elf import *
+import compile_diffs
 
 def read_all_bytes(data):
   data.seek(0)
@@ -398,6 +399,8 @@ try:
     f.write(yaml.dump(custom_symbols, Dumper=yaml.Dumper, default_flow_style=False) + '\n')
     print("Dumped custom symbols")
 
+  compile_diffs.compile_all()
+
   print("Finished generating diffs")
 
 except Exception as e:
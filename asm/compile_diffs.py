@@ -0,0 +1,117 @@
+# Converts the YAML patch diffs and custom symbols into the binary files the randomizer loads
+# assemble.py runs this after generating the diffs, it can also be run by itself
+# The build runs it with an output folder so the binaries always match the YAML
+#
+# All values are big-endian
+#
+# Patch diff (<name>_diff.bin):
+#   char[4]  magic "WWPD"
+#   u16      version
+#   u16      padding
+#   u32      number of data chunks
+#   u32      number of relocations
+#   data chunks, each:
+#     u32    address
+#     u32    length
+#     u8[]   bytes, padded to a multiple of 4
+#   relocations, each:
+#     u16    index of the relocation section it goes in
+#     u16    padding
+#     u32    r_offset
+#     u32    r_info
+#     s32    r_addend
+#
+# Custom symbols (custom_symbols.bin):
+#   char[4]  magic "WWSY"
+#   u16      version
+#   u16      padding
+#   u32      number of symbols
+#   symbols, each:
+#     u32    address
+#     u16    name length
+#     char[] name, not null-terminated
+
+import struct
+import glob
+import os
+import sys
+import yaml
+
+DIFF_MAGIC = b"WWPD"
+SYMBOLS_MAGIC = b"WWSY"
+VERSION = 1
+
+# Relocation sections in cking.rpx
+RELA_TEXT_INDEX = 7
+RELA_RODATA_INDEX = 8
+RELA_DATA_INDEX = 9
+
+asm_dir = os.path.dirname(os.path.abspath(__file__))
+
+def get_relocation_section(r_offset):
+  if r_offset >= 0x1018C0C0:
+    return RELA_DATA_INDEX
+  if r_offset >= 0x10000000:
+    return RELA_RODATA_INDEX
+  return RELA_TEXT_INDEX
+
+def compile_diff(diffs):
+  if "Data" not in diffs and "Relocations" not in diffs:
+    raise Exception("Patch diff has no data or relocations")
+
+  data = diffs.get("Data", {})
+  relocations = diffs.get("Relocations", [])
+
+  out = bytearray()
+  out += struct.pack(">4sHHII", DIFF_MAGIC, VERSION, 0, len(data), len(relocations))
+
+  for address, chunk in data.items():
+    chunk = bytes(chunk)
+    out += struct.pack(">II", address, len(chunk))
+    out += chunk
+    out += b"\0" * (-len(chunk) % 4)
+
+  for relocation in relocations:
+    for key in ("r_offset", "r_info", "r_addend"):
+      if key not in relocation:
+        raise Exception("Relocation is missing %s" % key)
+
+    r_offset = relocation["r_offset"]
+    out += struct.pack(">HHIII", get_relocation_section(r_offset), 0, r_offset, relocation["r_info"], relocation["r_addend"] & 0xFFFFFFFF)
+
+  return bytes(out)
+
+def compile_symbols(symbols):
+  out = bytearray()
+  out += struct.pack(">4sHHI", SYMBOLS_MAGIC, VERSION, 0, len(symbols))
+
+  for name, address in symbols.items():
+    name = name.encode("utf-8")
+    out += struct.pack(">IH", address, len(name))
+    out += name
+
+  return bytes(out)
+
+def compile_all(out_dir=asm_dir):
+  os.makedirs(os.path.join(out_dir, "patch_diffs"), exist_ok=True)
+  for bin_path in glob.glob(glob.escape(out_dir) + "/patch_diffs/*_diff.bin"):
+    os.remove(bin_path)
+
+  for diff_path in glob.glob(glob.escape(asm_dir) + "/patch_diffs/*_diff.yaml"):
+    with open(diff_path) as f:
+      diffs = yaml.safe_load(f)
+
+    bin_name = os.path.splitext(os.path.basename(diff_path))[0] + ".bin"
+    with open(os.path.join(out_dir, "patch_diffs", bin_name), "wb") as f:
+      f.write(compile_diff(diffs))
+
+  with open(os.path.join(asm_dir, "custom_symbols.yaml")) as f:
+    symbols = yaml.safe_load(f)
+
+  with open(os.path.join(out_dir, "custom_symbols.bin"), "wb") as f:
+    f.write(compile_symbols(symbols))
+
+if __name__ == "__main__":
+  # optional output folder, defaults to writing next to the YAML
+  compile_all(sys.argv[1] if len(sys.argv) > 1 else asm_dir)
+  print("Finished compiling diffs")
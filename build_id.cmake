@@ -0,0 +1,30 @@
+# Writes build_id.cpp, the build_id target runs this on every build
+# The ID is the git revision, plus a hash of any uncommitted changes so output from an edited build isn't reused
+# build_id.cpp is only rewritten when the ID changes, so an unchanged tree doesn't rebuild anything
+
+if(RELEASE_TAG OR NOT GIT_EXECUTABLE)
+  set(BUILD_ID "${GIT_TAG}")
+else()
+  execute_process(COMMAND "${GIT_EXECUTABLE}" rev-parse HEAD
+    WORKING_DIRECTORY "${SOURCE_DIR}"
+    OUTPUT_VARIABLE BUILD_ID
+    RESULT_VARIABLE GIT_RESULT
+    ERROR_QUIET OUTPUT_STRIP_TRAILING_WHITESPACE
+  )
+  execute_process(COMMAND "${GIT_EXECUTABLE}" diff HEAD
+    WORKING_DIRECTORY "${SOURCE_DIR}"
+    OUTPUT_VARIABLE GIT_DIFF
+    ERROR_QUIET
+  )
+
+  if(NOT GIT_RESULT EQUAL 0)
+    set(BUILD_ID "${GIT_TAG}")
+  elseif(NOT GIT_DIFF STREQUAL "")
+    string(SHA1 DIFF_HASH "${GIT_DIFF}")
+    set(BUILD_ID "${BUILD_ID}-dirty-${DIFF_HASH}")
+  endif()
+endif()
+
+file(WRITE "${OUTPUT}.tmp" "#include <version.hpp>\n\nconst char* const RANDOMIZER_BUILD_ID = \"${BUILD_ID}\";\n")
+execute_process(COMMAND "${CMAKE_COMMAND}" -E copy_if_different "${OUTPUT}.tmp" "${OUTPUT}")
+file(REMOVE "${OUTPUT}.tmp")
@@ -0,0 +1,177 @@
+#include "DecodeCache.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <atomic>
+#include <random>
+#include <filesystem>
+
+#include <version.hpp>
+#include <libs/hashing.hpp>
+#include <libs/zlib-ng.hpp>
+#include <utility/endian.hpp>
+#include <utility/file.hpp>
+#include <utility/string.hpp>
+#include <command/Log.hpp>
+
+using eType = Utility::Endian::Type;
+
+// Each entry is a header followed by the decoded data, all big-endian
+//   char[4] magic "WWDC"
+//   u16     version
+//   u16     key length
+//   u32     crc32 of the decoded data
+//   u64     decoded size
+//   char[]  key, not null-terminated
+static constexpr char ENTRY_MAGIC[4] = {'W', 'W', 'D', 'C'};
+static constexpr uint16_t ENTRY_VERSION = 1;
+
+
+
+void DecodeCache::setDir(const fspath& dir_) {
+    dir = dir_;
+
+    if(!dir.empty() && !Utility::create_directories(dir)) {
+        ErrorLog::getInstance().log("Failed to create decode cache folder " + Utility::toUtf8String(dir) + ", disabling cache");
+        dir.clear();
+    }
+
+    // entries from other versions will never be read again, they're hundreds of MB each
+    if(!dir.empty() && dir.parent_path() == getRootDir()) {
+        removeOtherVersions();
+    }
+}
+
+void DecodeCache::removeOtherVersions() const {
+    std::error_code ec;
+    for(const auto& entry : std::filesystem::directory_iterator(getRootDir(), ec)) {
+        if(entry.path() == dir || !entry.is_directory(ec)) continue;
+
+        if(std::filesystem::remove_all(entry.path(), ec); ec) {
+            ErrorLog::getInstance().log("Failed to remove old decode cache folder " + Utility::toUtf8String(entry.path()));
+        }
+    }
+}
+
+std::string DecodeCache::getKey(std::span<const char> encoded, const std::string& tag) const {
+    if(!isEnabled()) return "";
+
+    SHA1 sha1;
+    sha1.add(encoded.data(), encoded.size());
+
+    // the hash is raw bytes, the key is also the file name so it has to be hex
+    return Utility::Str::bytesToHex(sha1.getHash()) + '.' + tag;
+}
+
+bool DecodeCache::load(const std::string& key, Utility::ByteStream& out) const {
+    if(!isEnabled() || key.empty()) return false;
+
+    const fspath path = dir / key;
+    std::error_code ec;
+    if(!std::filesystem::is_regular_file(path, ec)) return false;
+
+    if(readEntry(path, key, out)) return true;
+
+    // a partial or corrupt entry would otherwise be read back on every run, drop it so the next decode replaces it
+    ErrorLog::getInstance().log("Decode cache entry " + key + " is invalid, removing it");
+    out.release();
+    std::filesystem::remove(path, ec);
+    return false;
+}
+
+void DecodeCache::store(const std::string& key, std::span<const char> decoded) const {
+    if(!isEnabled() || key.empty()) return;
+
+    // write to a unique temp file and rename it so other threads/processes never see a partial entry
+    static const std::string processTag = std::to_string(std::random_device()());
+    static std::atomic<size_t> tempCounter = 0;
+    const fspath path = dir / key;
+    const fspath tempPath = dir / (key + ".tmp" + processTag + '_' + std::to_string(tempCounter++));
+
+    {
+        std::ofstream output(tempPath, std::ios::binary);
+        if(output.is_open()) {
+            writeHeader(output, key, decoded);
+            output.write(decoded.data(), decoded.size());
+        }
+        // the last flush happens on close, check it so a full disk doesn't leave a truncated entry
+        output.close();
+        if(output.fail()) {
+            ErrorLog::getInstance().log("Failed to write decode cache entry " + key);
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if(ec) {
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+void DecodeCache::writeHeader(std::ostream& out, const std::string& key, std::span<const char> decoded) {
+    const uint32_t checksum = Utility::Endian::toPlatform(eType::Big, static_cast<uint32_t>(zng_crc32_z(0, reinterpret_cast<const uint8_t*>(decoded.data()), decoded.size())));
+    const uint64_t size = Utility::Endian::toPlatform(eType::Big, static_cast<uint64_t>(decoded.size()));
+    const uint16_t keyLength = Utility::Endian::toPlatform(eType::Big, static_cast<uint16_t>(key.size()));
+    const uint16_t version = Utility::Endian::toPlatform(eType::Big, ENTRY_VERSION);
+
+    out.write(ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+    out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    out.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+    out.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(key.data(), key.size());
+}
+
+bool DecodeCache::readEntry(const fspath& path, const std::string& key, Utility::ByteStream& out) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file.is_open()) return false;
+    const std::streamoff fileSize = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    char magic[sizeof(ENTRY_MAGIC)];
+    uint16_t version = 0, keyLength = 0;
+    uint32_t checksum = 0;
+    uint64_t size = 0;
+    if(!file.read(magic, sizeof(magic))) return false;
+    if(!file.read(reinterpret_cast<char*>(&version), sizeof(version))) return false;
+    if(!file.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength))) return false;
+    if(!file.read(reinterpret_cast<char*>(&checksum), sizeof(checksum))) return false;
+    if(!file.read(reinterpret_cast<char*>(&size), sizeof(size))) return false;
+    Utility::Endian::toPlatform_inplace(eType::Big, version);
+    Utility::Endian::toPlatform_inplace(eType::Big, keyLength);
+    Utility::Endian::toPlatform_inplace(eType::Big, checksum);
+    Utility::Endian::toPlatform_inplace(eType::Big, size);
+
+    if(std::memcmp(magic, ENTRY_MAGIC, sizeof(magic)) != 0 || version != ENTRY_VERSION) return false;
+    if(keyLength != key.size()) return false;
+
+    std::string storedKey(keyLength, '\0');
+    if(!file.read(storedKey.data(), keyLength) || storedKey != key) return false;
+
+    // the size is checked against the file before allocating anything for it
+    const std::streamoff dataOffset = file.tellg();
+    if(dataOffset < 0 || static_cast<uint64_t>(fileSize - dataOffset) != size) return false;
+
+    out.resize(size);
+    if(!file.read(out.data(), size)) return false;
+
+    return zng_crc32_z(0, reinterpret_cast<const uint8_t*>(out.data()), out.size()) == checksum;
+}
+
+fspath DecodeCache::getDefaultDir() {
+    // version strings can contain characters that aren't valid in folder names
+    std::string version = RANDOMIZER_VERSION;
+    for(char& c : version) {
+        if(!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '-' && c != '_') c = '_';
+    }
+
+    return getRootDir() / version;
+}
+
+fspath DecodeCache::getRootDir() {
+    return Utility::get_app_save_path() / "decode_cache";
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <span>
+#include <ostream>
+
+#include <utility/path.hpp>
+#include <utility/buffer.hpp>
+
+
+
+// On-disk cache of decoded container data (YAZ0 .dec, RPX .elf, etc)
+// Entries are keyed by a hash of the encoded input, and stored in a folder per randomizer version
+// Decoding the same dump for every seed is identical work, this lets it be done once
+class DecodeCache {
+public:
+    DecodeCache() = default;
+
+    void setDir(const fspath& dir_); //empty path disables the cache, a folder in the default root replaces the other versions there
+    bool isEnabled() const { return !dir.empty(); }
+
+    std::string getKey(std::span<const char> encoded, const std::string& tag) const; //returns an empty key if disabled
+    bool load(const std::string& key, Utility::ByteStream& out) const;
+    void store(const std::string& key, std::span<const char> decoded) const;
+
+    static fspath getDefaultDir();
+    static fspath getRootDir(); //holds the folder for each version
+
+private:
+    fspath dir = "";
+
+    void removeOtherVersions() const;
+
+    static void writeHeader(std::ostream& out, const std::string& key, std::span<const char> decoded);
+    static bool readEntry(const fspath& path, const std::string& key, Utility::ByteStream& out); //false if the entry is truncated or doesn't match its header
+};
@@ -0,0 +1,89 @@
+#include "OutputManifest.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+#include <libs/hashing.hpp>
+#include <utility/file.hpp>
+#include <utility/string.hpp>
+#include <command/Log.hpp>
+
+static constexpr char MANIFEST_NAME[] = "rando_manifest.txt";
+
+
+
+void OutputManifest::load(const fspath& outputDir) {
+    manifestPath = outputDir / MANIFEST_NAME;
+    previous.clear();
+    current.clear();
+
+    std::string contents;
+    std::error_code ec;
+    if(!std::filesystem::is_regular_file(manifestPath, ec)) return;
+    if(Utility::getFileContents(manifestPath, contents) != 0) return;
+
+    // one file per line: path \t input digest \t output hash
+    std::istringstream lines(contents);
+    for(std::string line; std::getline(lines, line);) {
+        const std::vector<std::string> parts = Utility::Str::split(line, '\t');
+        if(parts.size() != 3) continue;
+
+        previous[parts[0]] = {parts[1], parts[2]};
+    }
+}
+
+bool OutputManifest::isUpToDate(const fspath& relPath, const std::string& inputDigest) const {
+    const std::string key = relPath.generic_string();
+    if(inputDigest.empty() || !previous.contains(key)) return false;
+
+    const Record& record = previous.at(key);
+    if(record.inputDigest != inputDigest) return false;
+
+    // make sure the output wasn't replaced since it was written (first time setup, manual edits, etc)
+    const fspath outputPath = manifestPath.parent_path() / relPath;
+    std::error_code ec;
+    if(!std::filesystem::is_regular_file(outputPath, ec)) return false;
+
+    Utility::ByteStream output;
+    if(Utility::getFileContents(outputPath, output) != 0) return false;
+
+    SHA1 sha1;
+    return Utility::Str::bytesToHex(sha1(output.data(), output.size())) == record.outputHash;
+}
+
+void OutputManifest::record(const fspath& relPath, const std::string& inputDigest, std::span<const char> output) {
+    if(inputDigest.empty()) return;
+
+    // hashes are raw bytes, hex keeps them from breaking up the lines
+    SHA1 sha1;
+    Record record = {inputDigest, Utility::Str::bytesToHex(sha1(output.data(), output.size()))};
+
+    std::unique_lock<std::mutex> lock(currentMut);
+    current[relPath.generic_string()] = std::move(record);
+}
+
+void OutputManifest::keep(const fspath& relPath) {
+    const std::string key = relPath.generic_string();
+    if(!previous.contains(key)) return;
+
+    std::unique_lock<std::mutex> lock(currentMut);
+    current[key] = previous.at(key);
+}
+
+bool OutputManifest::write() {
+    if(manifestPath.empty()) return false;
+
+    std::ofstream output(manifestPath, std::ios::binary);
+    if(!output.is_open()) {
+        ErrorLog::getInstance().log("Failed to open " + Utility::toUtf8String(manifestPath));
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(currentMut);
+    for(const auto& [path, record] : current) {
+        output << path << '\t' << record.inputDigest << '\t' << record.outputHash << '\n';
+    }
+
+    return true;
+}
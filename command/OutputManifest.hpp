@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <span>
+#include <mutex>
+#include <unordered_map>
+
+#include <utility/path.hpp>
+
+
+
+// Record of what produced each file in the output folder
+// For every root file it stores a digest of the inputs to its actions and a hash of the data written
+// If a later run has the same inputs and the output is untouched, that file can be skipped entirely
+class OutputManifest {
+public:
+    OutputManifest() = default;
+
+    void load(const fspath& outputDir); //a missing or unreadable manifest just means nothing is up to date
+    bool isUpToDate(const fspath& relPath, const std::string& inputDigest) const;
+    void record(const fspath& relPath, const std::string& inputDigest, std::span<const char> output); //thread-safe
+    void keep(const fspath& relPath); //carry over the previous record for a skipped file
+    bool write();
+
+private:
+    struct Record {
+        std::string inputDigest;
+        std::string outputHash;
+    };
+
+    fspath manifestPath = "";
+    std::unordered_map<std::string, Record> previous;
+    std::unordered_map<std::string, Record> current;
+    std::mutex currentMut;
+};
@@ -0,0 +1,136 @@
+#include "OutputWriter.hpp"
+
+#include <fstream>
+#include <utility>
+
+#if defined(__linux__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+#elif defined(_WIN32)
+    #include <fcntl.h>
+    #include <io.h>
+#endif
+
+#include <command/Log.hpp>
+#include <command/Trace.hpp>
+
+
+
+OutputWriter::OutputWriter() :
+    thread(&OutputWriter::writerLoop, this) // started last, everything it uses is initialized above
+{}
+
+OutputWriter::~OutputWriter() {
+    {
+        std::scoped_lock lock(queueMut);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    thread.join();
+}
+
+void OutputWriter::write(const fspath& path, std::vector<char>&& data) {
+    std::unique_lock lock(queueMut);
+    spaceAvailable.wait(lock, [&]() { return queuedBytes == 0 || queuedBytes + data.size() <= queueLimit; });
+
+    queuedBytes += data.size();
+    jobs.push_back({path, std::move(data)});
+    lock.unlock();
+
+    jobAvailable.notify_one();
+}
+
+bool OutputWriter::flush() {
+    std::vector<fspath> toSync;
+    bool success;
+    {
+        std::unique_lock lock(queueMut);
+        idle.wait(lock, [this]() { return jobs.empty() && !writing; });
+
+        success = !failed;
+        failed = false;
+        toSync.swap(written);
+    }
+
+    if(!syncOnFlush) return success;
+
+    #if defined(__linux__) || defined(__APPLE__)
+        // done once at the end instead of per file, so the writes themselves can still be buffered by the OS
+        for(const fspath& path : toSync) {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if(fd < 0 || fsync(fd) != 0) {
+                ErrorLog::getInstance().log("Failed to sync " + Utility::toUtf8String(path));
+                success = false;
+            }
+            if(fd >= 0) close(fd);
+        }
+    #elif defined(_WIN32)
+        // _commit needs write access to flush the file
+        for(const fspath& path : toSync) {
+            const int fd = _wopen(path.c_str(), _O_WRONLY | _O_BINARY);
+            if(fd < 0 || _commit(fd) != 0) {
+                ErrorLog::getInstance().log("Failed to sync " + Utility::toUtf8String(path));
+                success = false;
+            }
+            if(fd >= 0) _close(fd);
+        }
+    #endif
+
+    return success;
+}
+
+bool OutputWriter::writeFile(const Job& job) {
+    #ifdef ENABLE_TIMING
+        ScopedTrace trace("Write", Utility::toUtf8String(job.path), "ROOT", job.data.size());
+    #endif
+
+    std::ofstream output(job.path, std::ios::binary);
+    if(!output.is_open()) return false;
+    output.write(job.data.data(), job.data.size());
+
+    // the last of the data is only flushed on close, a full disk can fail there
+    output.close();
+    return !output.fail();
+}
+
+void OutputWriter::writerLoop() {
+    std::deque<Job> batch;
+
+    while(true) {
+        {
+            std::unique_lock lock(queueMut);
+            writing = false;
+            if(jobs.empty()) {
+                idle.notify_all();
+            }
+            jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if(stopping && jobs.empty()) return;
+
+            // take everything that's queued, the lock is only held to swap the queue
+            batch.swap(jobs);
+            writing = true;
+        }
+
+        for(Job& job : batch) {
+            const bool success = writeFile(job);
+            if(!success) {
+                ErrorLog::getInstance().log("Failed to write " + Utility::toUtf8String(job.path));
+            }
+
+            const size_t size = job.data.size();
+            std::vector<char>().swap(job.data);
+            {
+                std::scoped_lock lock(queueMut);
+                queuedBytes -= size;
+                if(!success) {
+                    failed = true;
+                }
+                else if(syncOnFlush) {
+                    written.push_back(std::move(job.path));
+                }
+            }
+            spaceAvailable.notify_all();
+        }
+        batch.clear();
+    }
+}
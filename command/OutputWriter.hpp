@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <utility/path.hpp>
+
+
+
+// Writes finished output files on a background thread so repacking doesn't wait on slow storage
+// Queued data is owned by the writer, the queue is capped so it can't hold too much at once
+class OutputWriter {
+public:
+    #ifdef DEVKITPRO
+        static constexpr size_t DEFAULT_QUEUE_LIMIT = 32 * 1024 * 1024;
+    #else
+        static constexpr size_t DEFAULT_QUEUE_LIMIT = 256 * 1024 * 1024;
+    #endif
+
+    OutputWriter();
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    void setQueueLimit(const size_t& bytes) { queueLimit = bytes; }
+    void setSyncOnFlush(const bool& sync) { syncOnFlush = sync; } //fsync everything written when flushing
+    void write(const fspath& path, std::vector<char>&& data); //blocks while the queue is full, one file can always be queued
+    [[nodiscard]] bool flush(); //waits for every queued write, false if any of them failed since the last flush
+
+private:
+    struct Job {
+        fspath path;
+        std::vector<char> data;
+    };
+
+    std::mutex queueMut;
+    std::condition_variable jobAvailable;
+    std::condition_variable spaceAvailable;
+    std::condition_variable idle;
+    std::deque<Job> jobs;
+    size_t queuedBytes = 0;
+    size_t queueLimit = DEFAULT_QUEUE_LIMIT;
+    bool writing = false;
+    bool stopping = false;
+    bool failed = false;
+    bool syncOnFlush = false;
+    std::vector<fspath> written; //files to sync on the next flush
+    std::thread thread;
+
+    bool writeFile(const Job& job);
+    void writerLoop();
+};
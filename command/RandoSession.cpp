@@ -9,15 +9,19 @@
 #include <unordered_map>
 #include <fstream>
 #include <string>
+#include <span>
 
-#include <libs/BS_thread_pool.hpp>
+#include <libs/hashing.hpp>
 
+#include <version.hpp>
 #include <gui/desktop/update_dialog_header.hpp>
 #include <utility/string.hpp>
 #include <utility/platform.hpp>
 #include <utility/file.hpp>
 #include <utility/time.hpp>
+#include <utility/work_pool.hpp>
 #include <command/Log.hpp>
+#include <command/Trace.hpp>
 
 #include <filetypes/baseFiletype.hpp>
 #include <filetypes/bdt.hpp>
@@ -40,13 +44,27 @@
 RandoSession g_session; //definition for extern stuff
 
 #ifdef DEVKITPRO
-static BS::thread_pool workerThreads(3);
+static Utility::WorkStealingPool workerThreads(3);
 #else
-static BS::thread_pool workerThreads(std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4);
+static Utility::WorkStealingPool workerThreads(std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4);
 #endif
 
 static std::atomic<size_t> total_num_tasks = 0;
 static std::atomic<size_t> num_completed_tasks = 0;
+static std::atomic<bool> tasks_failed = false;
+
+static std::string hashData(std::span<const char> data) {
+    SHA1 sha1;
+    sha1.add(data.data(), data.size());
+    return sha1.getHash();
+}
+
+#ifdef ENABLE_TIMING
+    //only raw data has a meaningful size without re-serializing it
+    static size_t getRawSize(const RawFile* raw) {
+        return raw == nullptr ? 0 : raw->data.size();
+    }
+#endif
 
 static const std::unordered_map<std::string, RandoSession::CacheEntry::Format> str_to_format {
     {"BDT",    RandoSession::CacheEntry::Format::BDT},
@@ -69,7 +87,16 @@ static const std::unordered_map<std::string, RandoSession::CacheEntry::Format> s
 };
 
 void RandoSession::CacheEntry::addAction(Action_t action) {
+    addAction(action, session->actionKey);
+}
+
+void RandoSession::CacheEntry::addAction(Action_t action, const std::string& inputKey) {
     actions.push_back(action);
+    actionKeys.push_back(inputKey);
+}
+
+void RandoSession::CacheEntry::logTypeMismatch() const {
+    ErrorLog::getInstance().log("Action type does not match format of \"" + element.string() + "\"");
 }
 
 void RandoSession::CacheEntry::addDependent(std::shared_ptr<CacheEntry> depends) {
@@ -111,6 +138,30 @@ bool RandoSession::CacheEntry::isSibling(const std::shared_ptr<RandoSession::Cac
 }
 
 
+#ifdef ENABLE_TIMING
+    std::string RandoSession::getFormatName(const CacheEntry::Format& format) {
+        using Fmt = CacheEntry::Format;
+        if(format == Fmt::ROOT) return "ROOT";
+        if(format == Fmt::EMPTY) return "EMPTY";
+
+        for(const auto& [name, fmt] : str_to_format) {
+            if(fmt == format) return name;
+        }
+
+        return "UNKNOWN";
+    }
+
+    std::string RandoSession::getTracePath(const CacheEntry& entry) {
+        std::string path = entry.element.generic_string();
+        for(const CacheEntry* parent = entry.parent.get(); parent != nullptr && parent->storedFormat != CacheEntry::Format::EMPTY; parent = parent->parent.get()) {
+            path = parent->element.generic_string() + "@" + path;
+        }
+
+        return path;
+    }
+#endif
+
+
 RandoSession::RandoSession()
 {
 
@@ -140,308 +191,270 @@ bool RandoSession::init(const fspath& gameBaseDir, const fspath& randoOutputDir)
         return false;
     }
 
+    decodeCache.setDir(useDecodeCache ? DecodeCache::getDefaultDir() : "");
+
     clearCache();
     initialized = true;
 
     return true;
 }
 
-bool RandoSession::extractFile(std::shared_ptr<CacheEntry> current)
-{
-    RawFile* parentData = dynamic_cast<RawFile*>(current->parent->data.get());
+Utility::WorkStealingPool* RandoSession::getWorkerPool() const {
+    return &workerThreads;
+}
 
-    using Fmt = CacheEntry::Format;
-    switch(current->storedFormat) {
-        case Fmt::BDT:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::BDTFile>();
-            dynamic_cast<FileTypes::BDTFile*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::BFLIM:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::FLIMFile>();
-            dynamic_cast<FileTypes::FLIMFile*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::BFLYT:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::FLYTFile>();
-            dynamic_cast<FileTypes::FLYTFile*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::BFRES:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::resFile>();
-            dynamic_cast<FileTypes::resFile*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::CHARTS:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::ChartList>();
-            dynamic_cast<FileTypes::ChartList*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::DZX:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::DZXFile>();
-            dynamic_cast<FileTypes::DZXFile*>(current->data.get())->loadFromBinary(parentData->data.seekg(0, std::ios::beg));
-        }
-        break;
-        case Fmt::ELF:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::ELF>();
-            dynamic_cast<FileTypes::ELF*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::EVENTS:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::EventList>();
-            dynamic_cast<FileTypes::EventList*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::JPC:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::JPC>();
-            dynamic_cast<FileTypes::JPC*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::MSBP:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::MSBPFile>();
-            dynamic_cast<FileTypes::MSBPFile*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::MSBT:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::MSBTFile>();
-            dynamic_cast<FileTypes::MSBTFile*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::RPX:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<RawFile>();
-            if (RPXError err = FileTypes::rpx_decompress(parentData->data, dynamic_cast<RawFile*>(current->data.get())->data); err != RPXError::NONE)
-            {
-                ErrorLog::getInstance().log(std::string("Encountered RPXError on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
-                return false;
-            }
-        }
-        break;
-        case Fmt::SARC:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<FileTypes::SARCFile>();
-            dynamic_cast<FileTypes::SARCFile*>(current->data.get())->loadFromBinary(parentData->data);
-        }
-        break;
-        case Fmt::YAZ0:
-        {
-            if(parentData == nullptr) return false;
-            current->data = std::make_unique<RawFile>();
-            if (YAZ0Error err = FileTypes::yaz0Decode(parentData->data, dynamic_cast<RawFile*>(current->data.get())->data); err != YAZ0Error::NONE)
-            {
-                ErrorLog::getInstance().log(std::string("Encountered YAZ0Error on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
-                return false;
-            }
-        }
-        break;
-        case Fmt::STREAM:
-        {
-            if (current->parent->storedFormat == Fmt::SARC) {
-                FileTypes::SARCFile::File* file = dynamic_cast<FileTypes::SARCFile*>(current->parent->data.get())->getFile(current->element.string() + '\0');
-                if(file == nullptr) {
-                    ErrorLog::getInstance().log("Could not find " + current->element.string() + " in SARC");
-                    return false;
-                }
+RawFile* RandoSession::getRawData(CacheEntry& entry) {
+    if(!CacheEntry::holdsType<RawFile>(entry.storedFormat)) return nullptr;
+    return static_cast<RawFile*>(entry.data.get());
+}
 
-                current->data = std::make_unique<RawFile>(file->data);
-            }
-            else if (current->parent->storedFormat == Fmt::BFRES) {
-                const auto& files = dynamic_cast<FileTypes::resFile*>(current->parent->data.get())->files;
-                auto it = std::find_if(files.begin(), files.end(), [&](const FileTypes::resFile::FileSpec& spec) { return spec.fileName == current->element; });
-                if(it == files.end()) {
-                    ErrorLog::getInstance().log("Could not find " + current->element.string() + " in BFRES");
-                    return false;
-                }
+template<typename T>
+bool RandoSession::extractParsed(CacheEntry& current) {
+    RawFile* parentData = getRawData(*current.parent);
+    if(parentData == nullptr) return false;
 
-                const std::string& resData = dynamic_cast<FileTypes::resFile*>(current->parent->data.get())->fileData;
-                current->data = std::make_unique<RawFile>(resData.substr((*it).fileOffset - 0x6C, (*it).fileLength));
-            }
-            else {
-                return false; //what
-            }
-        }
-        break;
-        case Fmt::ROOT:
-        {
-            current->data = std::make_unique<RawFile>();
-            if(Utility::getFileContents((baseDir / current->element), dynamic_cast<RawFile*>(current->data.get())->data) != 0) return false;
-        }
-        break;
-        case Fmt::EMPTY:
-            [[fallthrough]];
-        default:
-            return false;
+    auto data = std::make_unique<T>();
+    data->loadFromBinary(parentData->data.seekg(0, std::ios::beg));
+    current.data = std::move(data);
+
+    parentData->data.release(); //clear parent buffer, don't need it
+    return true;
+}
+
+template<typename T>
+bool RandoSession::repackParsed(CacheEntry& current) {
+    RawFile* parentData = getRawData(*current.parent);
+    if(parentData == nullptr) return false;
+
+    static_cast<T*>(current.data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
+    return true;
+}
+
+bool RandoSession::extractSARC(CacheEntry& current) {
+    RawFile* parentData = getRawData(*current.parent);
+    if(parentData == nullptr) return false;
+
+    // the archive keeps the parent's buffer, files are only copied out of it when they're used
+    auto data = std::make_unique<FileTypes::SARCFile>();
+    if(SARCError err = data->loadFromBinary(parentData->data.take()); err != SARCError::NONE) {
+        ErrorLog::getInstance().log(std::string("Encountered SARCError on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
+        return false;
     }
+    current.data = std::move(data);
 
-    if(parentData != nullptr) parentData->data.str(std::string()); //clear parent sstream, don't need it
     return true;
 }
 
-bool RandoSession::repackFile(std::shared_ptr<CacheEntry> current)
-{
-    RawFile* parentData = dynamic_cast<RawFile*>(current->parent->data.get());
+bool RandoSession::extractRPX(CacheEntry& current) {
+    RawFile* parentData = getRawData(*current.parent);
+    if(parentData == nullptr) return false;
 
-    using Fmt = CacheEntry::Format;
-    switch(current->storedFormat) {
-        case Fmt::BDT:
-        {
-            return false; //TODO: how should file accesses be named here?
-        }
-        case Fmt::BFLIM:
-        {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::FLIMFile*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
-        }
-        return true;
-        case Fmt::BFLYT:
-        {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::FLYTFile*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
-        }
-        return true;
-        case Fmt::BFRES:
-        {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::resFile*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
-        }
-        return true;
-        case Fmt::CHARTS:
-        {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::ChartList*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
-        }
-        return true;
-        case Fmt::DZX:
-        {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::DZXFile*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
-        }
-        return true;
-        case Fmt::ELF:
-        {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::ELF*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
-        }
-        return true;
-        case Fmt::EVENTS:
-        {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::EventList*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
-        }
-        return true;
-        case Fmt::JPC:
-        {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::JPC*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
-        }
-        return true;
-        case Fmt::MSBP:
-        {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::MSBPFile*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
-        }
-        return true;
-        case Fmt::MSBT:
-        {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::MSBTFile*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
-        }
-        return true;
-        case Fmt::RPX:
-        {
-            if(parentData == nullptr) return false;
-            if (RPXError err = FileTypes::rpx_compress(dynamic_cast<RawFile*>(current->data.get())->data.seekg(0, std::ios::beg), parentData->data.seekp(0, std::ios::beg)); err != RPXError::NONE)
-            {
-                ErrorLog::getInstance().log(std::string("Encountered RPXError on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
-                return false;
-            }
-        }
-        return true;
-        case Fmt::SARC:
+    auto data = std::make_unique<RawFile>();
+    Utility::ByteStream& decoded = data->data;
+
+    const std::string cacheKey = decodeCache.getKey(parentData->data.span(), "elf");
+    if(!decodeCache.load(cacheKey, decoded)) {
+        if (RPXError err = FileTypes::rpx_decompress(parentData->data, decoded, &workerThreads); err != RPXError::NONE)
         {
-            if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::SARCFile*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
+            ErrorLog::getInstance().log(std::string("Encountered RPXError on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
+            return false;
         }
-        return true;
-        case Fmt::YAZ0:
+        decodeCache.store(cacheKey, decoded.span());
+    }
+    current.data = std::move(data);
+
+    parentData->data.release();
+    return true;
+}
+
+bool RandoSession::repackRPX(CacheEntry& current) {
+    RawFile* parentData = getRawData(*current.parent);
+    if(parentData == nullptr) return false;
+
+    if (RPXError err = FileTypes::rpx_compress(getRawData(current)->data.seekg(0, std::ios::beg), parentData->data.seekp(0, std::ios::beg), &workerThreads); err != RPXError::NONE)
+    {
+        ErrorLog::getInstance().log(std::string("Encountered RPXError on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
+        return false;
+    }
+    return true;
+}
+
+bool RandoSession::extractYAZ0(CacheEntry& current) {
+    RawFile* parentData = getRawData(*current.parent);
+    if(parentData == nullptr) return false;
+
+    auto data = std::make_unique<RawFile>();
+    Utility::ByteStream& decoded = data->data;
+
+    const std::string cacheKey = decodeCache.getKey(parentData->data.span(), "dec");
+    if(!decodeCache.load(cacheKey, decoded)) {
+        if (YAZ0Error err = FileTypes::yaz0Decode(parentData->data.span(), decoded); err != YAZ0Error::NONE)
         {
-            if(parentData == nullptr) return false;
-            //const uint32_t compressLevel = current->parent->storedFormat == Fmt::ROOT ? 1 : 9;
-            if (YAZ0Error err = FileTypes::yaz0Encode(dynamic_cast<RawFile*>(current->data.get())->data, parentData->data.seekp(0, std::ios::beg), 7); err != YAZ0Error::NONE)
-            {
-                ErrorLog::getInstance().log(std::string("Encountered YAZ0Error on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
-                return false;
-            }
+            ErrorLog::getInstance().log(std::string("Encountered YAZ0Error on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
+            return false;
         }
-        return true;
-        case Fmt::STREAM:
-        {
-            if (current->parent->storedFormat == Fmt::SARC) {
-                FileTypes::SARCFile* file = dynamic_cast<FileTypes::SARCFile*>(current->parent->data.get());
-                if(file == nullptr) {
-                    ErrorLog::getInstance().log("Could not get parent SARC of " + current->element.string());
-                    return false;
-                }
+        decodeCache.store(cacheKey, decoded.span());
+    }
+    current.decodedHash = hashData(decoded.span());
+    current.data = std::move(data);
 
-                file->replaceFile(current->element.string() + '\0', dynamic_cast<RawFile*>(current->data.get())->data);
-            }
-            else if (current->parent->storedFormat == Fmt::BFRES) {
-                FileTypes::resFile* file = dynamic_cast<FileTypes::resFile*>(current->parent->data.get());
-                if(file == nullptr) {
-                    ErrorLog::getInstance().log("Could not get parent BFRES of" + current->element.string());
-                    return false;
-                }
+    current.originalEncoded = parentData->data.take(); //kept in case nothing changes the decoded data
+    return true;
+}
 
-                file->replaceEmbeddedFile(current->element.string(), dynamic_cast<RawFile*>(current->data.get())->data);
+bool RandoSession::repackYAZ0(CacheEntry& current) {
+    RawFile* parentData = getRawData(*current.parent);
+    if(parentData == nullptr) return false;
+
+    // files are often opened just so something else can read them, re-encoding unchanged data would give the same file back
+    const std::span<const char> decoded = getRawData(current)->data.span();
+    std::vector<char> original = std::move(current.originalEncoded);
+    bool reuseOriginal = !original.empty() && hashData(decoded) == current.decodedHash;
+    #ifdef ENABLE_DEBUG
+        // the reused bytes have to decode back to exactly what the children left behind
+        if(reuseOriginal) {
+            Utility::ByteStream roundTrip;
+            if(FileTypes::yaz0Decode(std::span<const char>(original), roundTrip) != YAZ0Error::NONE || !std::ranges::equal(roundTrip.span(), decoded)) {
+                ErrorLog::getInstance().log("Original YAZ0 data for " + current.element.string() + " does not round-trip, re-encoding");
+                reuseOriginal = false;
             }
         }
+    #endif
+    if(reuseOriginal) {
+        parentData->data.assign(std::move(original));
         return true;
-        case Fmt::ROOT:
-        {
-            std::ofstream output(outputDir / current->element, std::ios::binary);
-            if(!output.is_open()) return false;
-            const std::string& data = dynamic_cast<RawFile*>(current->data.get())->data.str();
-            output.write(&data[0], data.size());
+    }
+    original = {};
+
+    // big archives are split across the pool, otherwise one of them ends up being the last thing running
+    const FileTypes::Yaz0EncodeOptions options = {
+        .profile = current.yaz0Profile.value_or(yaz0Profile),
+        .pool = &workerThreads,
+    };
+    if (YAZ0Error err = FileTypes::yaz0Encode(decoded, parentData->data, options); err != YAZ0Error::NONE)
+    {
+        ErrorLog::getInstance().log(std::string("Encountered YAZ0Error on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
+        return false;
+    }
+    return true;
+}
+
+bool RandoSession::extractStream(CacheEntry& current) {
+    using Fmt = CacheEntry::Format;
+    if (current.parent->storedFormat == Fmt::SARC) {
+        // the SARC only views the file, this entry's copy is the one actions modify
+        // the original bytes stay in the archive's buffer until it's freed, so a member is held twice while it's open
+        const auto file = static_cast<const FileTypes::SARCFile*>(current.parent->data.get())->viewFile(current.element.string() + '\0');
+        if(!file.has_value()) {
+            ErrorLog::getInstance().log("Could not find " + current.element.string() + " in SARC");
+            return false;
         }
-        return true;
-        case Fmt::EMPTY:
-            [[fallthrough]];
-        default:
+
+        current.data = std::make_unique<RawFile>(file.value());
+    }
+    else if (current.parent->storedFormat == Fmt::BFRES) {
+        const FileTypes::resFile& res = *static_cast<FileTypes::resFile*>(current.parent->data.get());
+        auto it = std::find_if(res.files.begin(), res.files.end(), [&](const FileTypes::resFile::FileSpec& spec) { return spec.fileName == current.element; });
+        if(it == res.files.end()) {
+            ErrorLog::getInstance().log("Could not find " + current.element.string() + " in BFRES");
             return false;
+        }
+
+        current.data = std::make_unique<RawFile>(std::span(res.fileData).subspan((*it).fileOffset - 0x6C, (*it).fileLength));
+    }
+    else {
+        return false; //what
     }
+
+    return true;
 }
 
-std::shared_ptr<RandoSession::CacheEntry> RandoSession::getEntry(const std::vector<std::string>& fileSpec) {
+bool RandoSession::repackStream(CacheEntry& current) {
+    using Fmt = CacheEntry::Format;
+    if (current.parent->storedFormat == Fmt::SARC) {
+        static_cast<FileTypes::SARCFile*>(current.parent->data.get())->replaceFile(current.element.string() + '\0', getRawData(current)->data.span());
+    }
+    else if (current.parent->storedFormat == Fmt::BFRES) {
+        static_cast<FileTypes::resFile*>(current.parent->data.get())->replaceEmbeddedFile(current.element.string(), getRawData(current)->data.span());
+    }
+    return true;
+}
+
+bool RandoSession::extractRoot(CacheEntry& current) {
+    auto data = std::make_unique<RawFile>();
+    if(Utility::getFileContents((baseDir / current.element), data->data) != 0) return false;
+    current.data = std::move(data);
+
+    return true;
+}
+
+bool RandoSession::repackRoot(CacheEntry& current) {
+    Utility::ByteStream& data = getRawData(current)->data;
+    if(incrementalOutput) {
+        manifest.record(current.element, current.inputDigest, data.span());
+    }
+
+    // the writer takes the buffer, this thread can move on while it's written
+    outputWriter.write(outputDir / current.element, data.take());
+    return true;
+}
+
+bool RandoSession::repackUnsupported(CacheEntry& current) {
+    return false; //TODO: how should file accesses be named here?
+}
+
+const RandoSession::Codec& RandoSession::getCodec(const CacheEntry::Format& format) {
+    // indexed by format, adding a format only needs an entry here and in CacheEntry::holdsType
+    static constexpr Codec codecs[] = {
+        {&RandoSession::extractParsed<FileTypes::BDTFile>,   &RandoSession::repackUnsupported},                   // BDT
+        {&RandoSession::extractParsed<FileTypes::FLIMFile>,  &RandoSession::repackParsed<FileTypes::FLIMFile>},  // BFLIM
+        {&RandoSession::extractParsed<FileTypes::FLYTFile>,  &RandoSession::repackParsed<FileTypes::FLYTFile>},  // BFLYT
+        {&RandoSession::extractParsed<FileTypes::resFile>,   &RandoSession::repackParsed<FileTypes::resFile>},   // BFRES
+        {&RandoSession::extractParsed<FileTypes::ChartList>, &RandoSession::repackParsed<FileTypes::ChartList>}, // CHARTS
+        {&RandoSession::extractParsed<FileTypes::DZXFile>,   &RandoSession::repackParsed<FileTypes::DZXFile>},   // DZX
+        {&RandoSession::extractParsed<FileTypes::ELF>,       &RandoSession::repackParsed<FileTypes::ELF>},       // ELF
+        {&RandoSession::extractParsed<FileTypes::EventList>, &RandoSession::repackParsed<FileTypes::EventList>}, // EVENTS
+        {&RandoSession::extractParsed<FileTypes::JPC>,       &RandoSession::repackParsed<FileTypes::JPC>},       // JPC
+        {&RandoSession::extractParsed<FileTypes::MSBPFile>,  &RandoSession::repackParsed<FileTypes::MSBPFile>},  // MSBP
+        {&RandoSession::extractParsed<FileTypes::MSBTFile>,  &RandoSession::repackParsed<FileTypes::MSBTFile>},  // MSBT
+        {&RandoSession::extractRPX,                          &RandoSession::repackRPX},                          // RPX
+        {&RandoSession::extractSARC,                         &RandoSession::repackParsed<FileTypes::SARCFile>},  // SARC
+        {&RandoSession::extractYAZ0,                         &RandoSession::repackYAZ0},                         // YAZ0
+        {&RandoSession::extractStream,                       &RandoSession::repackStream},                       // STREAM
+        {&RandoSession::extractRoot,                         &RandoSession::repackRoot},                         // ROOT
+    };
+    static_assert(std::size(codecs) == static_cast<size_t>(CacheEntry::Format::EMPTY), "Every format except EMPTY needs a codec");
+
+    return codecs[static_cast<size_t>(format)];
+}
+
+bool RandoSession::extractFile(std::shared_ptr<CacheEntry> current)
+{
+    if(current->storedFormat >= CacheEntry::Format::EMPTY) return false;
+
+    return (this->*getCodec(current->storedFormat).extract)(*current);
+}
+
+bool RandoSession::repackFile(std::shared_ptr<CacheEntry> current)
+{
+    if(current->storedFormat >= CacheEntry::Format::EMPTY) return false;
+
+    return (this->*getCodec(current->storedFormat).repack)(*current);
+}
+
+RandoSession::PathHandle RandoSession::resolvePath(const fspath& relPath) {
+    // the same paths get opened over and over, only split and build keys the first time
+    const std::string pathStr = relPath.string();
+    if(const auto& it = handlesByPath.find(pathStr); it != handlesByPath.end()) {
+        return it->second;
+    }
+
     // ["content/Common/Stage/example.szs", "YAZ0", "SARC", "data.bfres"]
     // first part is an extant game file
+    const std::vector<std::string> fileSpec = Utility::Str::split(pathStr, '@');
     std::string cacheKey{""};
     std::string resultKey{""};
-    std::shared_ptr<CacheEntry> parentEntry = fileCache;
-    std::shared_ptr<CacheEntry> nextEntry = nullptr;
+    PathHandle parentHandle = NO_PATH;
 
     for (size_t i = 0; i < fileSpec.size(); i++)
     {
@@ -469,11 +482,12 @@ std::shared_ptr<RandoSession::CacheEntry> RandoSession::getEntry(const std::vect
         {
             resultKey = cacheKey + element;
         }
-        // if we've already cached this
-        if (parentEntry->children.count(resultKey) > 0)
+        cacheKey = resultKey;
+
+        // keys include everything above them, so they're unique across the whole tree
+        if (const auto& it = handlesByKey.find(cacheKey); it != handlesByKey.end())
         {
-            cacheKey = resultKey;
-            parentEntry = parentEntry->children.at(cacheKey);
+            parentHandle = it->second;
             continue;
         }
 
@@ -490,32 +504,61 @@ std::shared_ptr<RandoSession::CacheEntry> RandoSession::getEntry(const std::vect
             }
         }
 
-        parentEntry->children[resultKey] = std::make_shared<CacheEntry>(parentEntry, element, fmt);
-        nextEntry = parentEntry->children[resultKey];
-        cacheKey = resultKey;
-        parentEntry = nextEntry;
+        const PathHandle handle = static_cast<PathHandle>(pathNodes.size());
+        pathNodes.push_back({parentHandle, element, cacheKey, fmt});
+        handlesByKey.emplace(cacheKey, handle);
+        parentHandle = handle;
+    }
+
+    handlesByPath.emplace(pathStr, parentHandle);
+    return parentHandle;
+}
+
+std::shared_ptr<RandoSession::CacheEntry> RandoSession::getEntry(const PathHandle& handle) {
+    if(handle == NO_PATH) return fileCache;
+
+    if(handle >= entriesByHandle.size()) {
+        entriesByHandle.resize(pathNodes.size());
+    }
+    if(entriesByHandle[handle] != nullptr) {
+        return entriesByHandle[handle];
     }
 
-    return parentEntry;
+    const PathNode& node = pathNodes[handle];
+    const std::shared_ptr<CacheEntry> parentEntry = getEntry(node.parent);
+    std::shared_ptr<CacheEntry>& child = parentEntry->children[node.key];
+    if(child == nullptr) {
+        child = std::make_shared<CacheEntry>(this, parentEntry, node.element, node.format);
+
+        //files nested in a pack can have their own profile, but a fast run stays fast
+        if(node.format == CacheEntry::Format::YAZ0 && parentEntry->storedFormat == CacheEntry::Format::SARC && nestedYaz0Profile.has_value() && yaz0Profile != FileTypes::Yaz0Profile::FAST) {
+            child->setYaz0Profile(nestedYaz0Profile.value());
+        }
+    }
+
+    entriesByHandle[handle] = child;
+    return child;
 }
 
 RandoSession::CacheEntry& RandoSession::openGameFile(const fspath& relPath)
 {
     //CHECK_INITIALIZED(nullptr);
-    return *getEntry(Utility::Str::split(relPath.string(), '@'));
+    return openGameFile(resolvePath(relPath));
+}
+
+RandoSession::CacheEntry& RandoSession::openGameFile(const PathHandle& handle)
+{
+    return *getEntry(handle);
 }
 
 bool RandoSession::copyToGameFile(const fspath& source, const fspath& relPath, const bool& resourceFile /* = false*/) {
     CHECK_INITIALIZED(false);
 
     RandoSession::CacheEntry& entry = openGameFile(relPath);
-    entry.addAction([source, resourceFile](RandoSession* session, FileType* data) -> int {
-        RawFile* dst = dynamic_cast<RawFile*>(data);
-        if(dst == nullptr) return false;
-        dst->data.str(std::string()); //clear data so we overwrite it
+    entry.addAction<RawFile>([source, resourceFile](RandoSession* session, RawFile& dst) -> int {
         std::string fileData = "";
         if(Utility::getFileContents(source, fileData, resourceFile) != 0) return false; //TODO: proper time against rdbuf
-        dst->data.str(fileData); 
+        dst.data.assign(fileData); //overwrite existing data
 
         return true;
     });
@@ -530,60 +573,267 @@ bool RandoSession::restoreGameFile(const fspath& relPath) { //Restores a file fr
     return true;
 }
 
-bool RandoSession::handleChildren(const fspath filename, std::shared_ptr<CacheEntry> current) {
-    if(current->parent->parent == nullptr) { //only print start of chain to avoid spam
-        Utility::platformLog("Working on " + filename.string());
+// The cache tree is run as a task graph:
+// an entry starts once its parent is extracted and its prereqs are finished, children run in parallel
+// the last child to finish repacks the parent on the same thread, finishing an entry releases its dependents
+void RandoSession::prepareEntry(const std::shared_ptr<CacheEntry> current) {
+    current->pendingChildren = current->children.size();
+    current->finished = false;
+
+    for(auto& [filename, child] : current->children) {
+        child->incrementPrereq(); //wait for this entry to be extracted
+        prepareEntry(child);
     }
-    //extract this level, move down tree
-    if(!extractFile(current)) return false;
+}
 
-    //has mods to stream (item location edits), handle these before filetype stuff
-    if(current->children.size() == 1 && current->actions.size() != 0 && dynamic_cast<RawFile*>(current->data.get()) != nullptr) {
-        for(auto& action : current->actions) {
-            action(this, current->data.get());
+void RandoSession::scheduleEntry(std::shared_ptr<CacheEntry> current) {
+    //roots go through the memory budget, everything else belongs to a root that's already running
+    if(current->storedFormat == CacheEntry::Format::ROOT) {
+        {
+            std::scoped_lock lock(rootQueueMut);
+            queuedRoots.push_back(current);
+        }
+        startQueuedRoots();
+        return;
+    }
+
+    workerThreads.push([this, current]() { runEntry(current); });
+}
+
+size_t RandoSession::estimateMemory(const std::shared_ptr<CacheEntry> root) const {
+    const fspath path = baseDir / root->element;
+    std::error_code ec;
+    const size_t fileSize = std::filesystem::file_size(path, ec);
+    if(ec) return 0;
+
+    // raw file + decoded copy + unpacked copy of it
+    std::ifstream file(path, std::ios::binary);
+    if(const uint32_t decodedSize = FileTypes::yaz0GetDecodedSize(file); decodedSize != 0) {
+        return fileSize + size_t(decodedSize) * 2;
+    }
+
+    // no header to go off of (RPX, packs), assume it roughly doubles
+    return fileSize * 2;
+}
+
+void RandoSession::startQueuedRoots(const bool& force) {
+    std::vector<std::shared_ptr<CacheEntry>> toStart;
+    {
+        std::scoped_lock lock(rootQueueMut);
+        while(!queuedRoots.empty()) {
+            const std::shared_ptr<CacheEntry>& next = queuedRoots.front();
+
+            //always let one through, a file larger than the budget still has to be done
+            const bool fits = memoryBudget == 0 || memoryInUse == 0 || memoryInUse + next->memoryEstimate <= memoryBudget;
+            if(!fits && !force) break;
+
+            memoryInUse += next->memoryEstimate;
+            toStart.push_back(next);
+            queuedRoots.pop_front();
+
+            if(force) break; //only needs to unblock things
+        }
+    }
+
+    for(const auto& root : toStart) {
+        workerThreads.push([this, root]() { runEntry(root); });
+    }
+}
+
+void RandoSession::runEntry(std::shared_ptr<CacheEntry> current) {
+    const bool isRoot = current->storedFormat == CacheEntry::Format::ROOT;
+    if(isRoot) { //only print start of chain to avoid spam
+        Utility::platformLog("Working on " + current->element.string());
+    }
+
+    //extract this level
+    bool extracted;
+    {
+        #ifdef ENABLE_TIMING
+            ScopedTrace trace("extract", getTracePath(*current), getFormatName(current->storedFormat));
+        #endif
+
+        if(isRoot) {
+            extracted = extractFile(current);
         }
+        else {
+            //siblings repack into the parent's data, only read its size under the lock
+            std::scoped_lock lock(current->parent->childMut);
+            #ifdef ENABLE_TIMING
+                trace.setBytesIn(getRawSize(getRawData(*current->parent)));
+            #endif
+
+            extracted = extractFile(current);
+        }
+
+        #ifdef ENABLE_TIMING
+            trace.setBytesOut(getRawSize(getRawData(*current)));
+        #endif
+    }
+
+    if(!extracted) {
+        ErrorLog::getInstance().log("Failed to extract " + current->element.string());
+        tasks_failed = true;
+
+        //still release everything waiting on this so the graph drains, nothing to repack
+        current->setFinished();
+        finishEntry(current);
+        return;
+    }
+
+    //has mods to stream (item location edits), handle these before filetype stuff
+    if(current->children.size() == 1 && current->actions.size() != 0 && getRawData(*current) != nullptr) {
+        runActions(current);
     }
 
     //bottom of branch, run mods
     if(current->children.size() == 0) {
-        for(auto& action : current->actions) {
-            action(this, current->data.get());
-        }
+        runActions(current);
+
+        finishEntry(current);
+        return;
     }
-    else { //modify, repack children
-        for(auto& [filename, child] : current->children) {
-            if(child->getNumPrereqs() > 0 || child->isFinished() == true) continue; //skip this child, prereq did/will do it
 
-            RandoSession::handleChildren(filename, child);
+    //move down tree, keep the last ready child on this thread
+    //copy the children first, once one is released the last child out can clear current->children
+    std::vector<std::shared_ptr<CacheEntry>> children;
+    children.reserve(current->children.size());
+    for(const auto& [filename, child] : current->children) {
+        children.push_back(child);
+    }
+
+    std::shared_ptr<CacheEntry> next = nullptr;
+    for(const auto& child : children) {
+        if(child->decrementPrereq() > 0) continue; //a prereq will start it when it finishes
+
+        if(next != nullptr) {
+            scheduleEntry(next);
         }
+        next = child;
     }
 
+    if(next != nullptr) {
+        runEntry(next);
+    }
+}
+
+void RandoSession::runActions(std::shared_ptr<CacheEntry> current) {
+    for(auto& action : current->actions) {
+        #ifdef ENABLE_TIMING
+            ScopedTrace trace("action", getTracePath(*current), getFormatName(current->storedFormat), getRawSize(getRawData(*current)));
+        #endif
+
+        action(this, current->data.get());
+
+        #ifdef ENABLE_TIMING
+            trace.setBytesOut(getRawSize(getRawData(*current)));
+        #endif
+    }
+}
+
+void RandoSession::finishEntry(std::shared_ptr<CacheEntry> current) {
     //repack this level
-    repackFile(current);
+    if(!current->isFinished()) {
+        const bool isRoot = current->storedFormat == CacheEntry::Format::ROOT;
+
+        #ifdef ENABLE_TIMING
+            const size_t bytesIn = getRawSize(getRawData(*current));
+            ScopedTrace trace("repack", getTracePath(*current), getFormatName(current->storedFormat), bytesIn);
+        #endif
+
+        bool repacked;
+        if(isRoot) {
+            repacked = repackFile(current);
+
+            #ifdef ENABLE_TIMING
+                trace.setBytesOut(bytesIn); //roots hand their data to the output writer unchanged
+            #endif
+        }
+        else {
+            std::scoped_lock lock(current->parent->childMut);
+            repacked = repackFile(current);
+
+            #ifdef ENABLE_TIMING
+                trace.setBytesOut(getRawSize(getRawData(*current->parent)));
+            #endif
+        }
+
+        if(!repacked && current->storedFormat != CacheEntry::Format::BDT) { //BDT repacking isn't implemented, it's only read
+            ErrorLog::getInstance().log("Failed to repack " + current->element.string());
+            tasks_failed = true;
+        }
 
-    current->setFinished();
+        current->setFinished();
+    }
 
     //handle dependents
     for(auto& dependent : current->dependents) {
         //check if this is the last dependency
         if(dependent->decrementPrereq() > 0) continue; //decrement returns new value
 
-        //handle the data
-        if(current->isSibling(dependent)) { //IMPROVEMENT: more precise sibling checks, filename stuff
-            RandoSession::handleChildren(filename / dependent->element, dependent);
-        }
-        else { //IMPROVEMENT: check entry is root, handle other edge cases
-            workerThreads.push_task(&RandoSession::handleChildren, this, dependent->element, dependent); //add root of this other chain
-        }
+        scheduleEntry(dependent);
     }
 
     //clear children once done
     current->children.clear();
+    current->data = nullptr;
 
     //update progress if this is the root of the chain
     if(current->storedFormat == CacheEntry::Format::ROOT) {
+        {
+            std::scoped_lock lock(rootQueueMut);
+            memoryInUse -= current->memoryEstimate;
+        }
+        startQueuedRoots();
+
         num_completed_tasks++;
         UPDATE_DIALOG_VALUE(int(99.0f - ((float((total_num_tasks - num_completed_tasks)/float(total_num_tasks))) * 50.0f))); //also update progress bar
+        return;
+    }
+
+    //last child out repacks the parent
+    if(current->parent->pendingChildren.fetch_sub(1) == 1) {
+        finishEntry(current->parent);
+    }
+}
+
+std::string RandoSession::getInputDigest(const std::shared_ptr<CacheEntry> root) const {
+    // the output also depends on the base file and the exact randomizer build
+    std::error_code ec;
+    const fspath basePath = baseDir / root->element;
+    const uintmax_t baseSize = std::filesystem::file_size(basePath, ec);
+    if(ec) return "";
+    const auto baseTime = std::filesystem::last_write_time(basePath, ec);
+    if(ec) return "";
+
+    std::string input = RANDOMIZER_BUILD_ID;
+    input += '\n' + std::to_string(baseSize) + '\n' + std::to_string(baseTime.time_since_epoch().count()) + '\n';
+    if(!appendDigestInput(input, root->element.generic_string(), *root)) return "";
+
+    SHA1 sha1;
+    return Utility::Str::bytesToHex(sha1(input)); //stored in the text manifest
+}
+
+bool RandoSession::appendDigestInput(std::string& out, const std::string& key, const CacheEntry& entry) const {
+    // anything linked to other files can't be predicted from this tree alone
+    if(entry.getNumPrereqs() > 0 || !entry.dependents.empty()) return false;
+
+    out += key + '\n' + std::to_string(static_cast<int>(entry.storedFormat)) + '\n';
+    for(const std::string& actionKey : entry.actionKeys) {
+        if(actionKey.empty()) return false; //action didn't say what it depends on
+        out += actionKey + '\n';
+    }
+
+    // children are unordered, sort them so the digest is stable
+    std::vector<std::string> childKeys;
+    childKeys.reserve(entry.children.size());
+    for(const auto& [childKey, child] : entry.children) {
+        childKeys.push_back(childKey);
+    }
+    std::sort(childKeys.begin(), childKeys.end());
+
+    for(const std::string& childKey : childKeys) {
+        if(!appendDigestInput(out, childKey, *entry.children.at(childKey))) return false;
     }
 
     return true;
@@ -643,6 +893,49 @@ static bool iterate_directory_recursive(RandoSession& session, const fspath cur)
 }
 #endif
 
+#ifndef DEVKITPRO
+bool RandoSession::copyDump() {
+    std::atomic<bool> copyFailed = false;
+
+    for(const char* folder : {"code", "content", "meta"}) {
+        std::error_code ec;
+        for(auto it = std::filesystem::recursive_directory_iterator(baseDir / folder, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            const fspath relPath = it->path().lexically_relative(baseDir);
+
+            if(it->is_directory(ec)) {
+                if(!Utility::create_directories(outputDir / relPath)) {
+                    ErrorLog::getInstance().log("Failed to create dir: " + Utility::toUtf8String(outputDir / relPath));
+                    workerThreads.wait(); //queued copies still reference copyFailed
+                    return false;
+                }
+                continue;
+            }
+
+            // modFiles writes every root anyway, copying them first is wasted work
+            if(fileCache->children.contains(relPath.generic_string())) {
+                continue;
+            }
+
+            workerThreads.push([this, relPath, &copyFailed]() {
+                if(!Utility::clone_file(baseDir / relPath, outputDir / relPath)) {
+                    ErrorLog::getInstance().log("Failed to copy " + Utility::toUtf8String(relPath));
+                    copyFailed = true;
+                }
+            });
+        }
+
+        if(ec) {
+            ErrorLog::getInstance().log("Failed to read dump folder " + Utility::toUtf8String(baseDir / folder) + ": " + ec.message());
+            workerThreads.wait();
+            return false;
+        }
+    }
+
+    workerThreads.wait();
+    return !copyFailed;
+}
+#endif
+
 bool RandoSession::runFirstTimeSetup() {
     #ifdef DEVKITPRO
         // create folders and add all game files to RandoSession (it will thread the copies and skip anything that we will modify and overwrite)
@@ -657,9 +950,9 @@ bool RandoSession::runFirstTimeSetup() {
  
         Utility::platformLog("Copying dump to output...");
         UPDATE_DIALOG_LABEL("Copying dump to output...");
-        std::filesystem::copy(baseDir / "code", outputDir / "code", std::filesystem::copy_options::recursive);
-        std::filesystem::copy(baseDir / "content", outputDir / "content", std::filesystem::copy_options::recursive);
-        std::filesystem::copy(baseDir / "meta", outputDir / "meta", std::filesystem::copy_options::recursive);
+        if(!copyDump()) {
+            return false;
+        }
     #endif
 
     setFirstTimeSetup(false);
@@ -682,24 +975,86 @@ bool RandoSession::modFiles()
         }
     }
 
+    if(incrementalOutput) {
+        manifest.load(outputDir);
+    }
+
     total_num_tasks = fileCache->children.size();
+    std::vector<std::shared_ptr<CacheEntry>> roots;
+    roots.reserve(fileCache->children.size());
     for(auto& [filename, child] : fileCache->children) {
+        if(incrementalOutput) {
+            child->inputDigest = getInputDigest(child);
+            if(manifest.isUpToDate(child->element, child->inputDigest)) {
+                manifest.keep(child->element);
+                num_completed_tasks++;
+                continue;
+            }
+        }
+
+        child->memoryEstimate = estimateMemory(child); //also orders the roots, so it's needed without a budget
+        roots.push_back(child);
+    }
+
+    // start the biggest files first so one doesn't end up running alone at the end
+    std::stable_sort(roots.begin(), roots.end(), [](const auto& a, const auto& b) { return a->memoryEstimate > b->memoryEstimate; });
+
+    // set up the whole graph before anything runs, dependents can be anywhere in it
+    for(const auto& root : roots) {
+        prepareEntry(root);
+    }
+
+    for(const auto& root : roots) {
         //has dependency, it will add it when necessary
-        if(child->getNumPrereqs() > 0) {
+        if(root->getNumPrereqs() > 0) {
             continue;
         }
 
-        workerThreads.push_task(&RandoSession::handleChildren, this, filename, child);  
+        scheduleEntry(root);
     }
     
     // uncache everything
     // do this now so the shared_ptrs free themselves as the tasks finish
     // this prevents file data from hanging around in RAM (which softlocks on console, probably gets too full)
     fileCache->children.clear();
+    entriesByHandle.clear();
 
     UPDATE_DIALOG_LABEL("Repacking Files...");
 
-    workerThreads.wait_for_tasks();
+    while(true) {
+        workerThreads.wait();
+
+        bool waiting;
+        {
+            std::scoped_lock lock(rootQueueMut);
+            waiting = !queuedRoots.empty();
+        }
+        if(!waiting) break;
+
+        //nothing is running but files are still queued, whatever is using the budget is waiting on one of them
+        startQueuedRoots(true);
+    }
+
+    if(!outputWriter.flush()) {
+        ErrorLog::getInstance().log("Failed to write some output files!");
+        tasks_failed = true;
+    }
+
+    if(incrementalOutput && !manifest.write()) {
+        // not fatal, the next run just won't skip anything
+        ErrorLog::getInstance().log("Failed to write output manifest");
+    }
+
+    #ifdef ENABLE_TIMING
+        if(!TraceLog::getInstance().write()) {
+            ErrorLog::getInstance().log("Failed to write trace to " + Utility::toUtf8String(TraceLog::getInstance().LOG_PATH));
+        }
+    #endif
+
+    if(tasks_failed) {
+        ErrorLog::getInstance().log("Failed to repack some files!");
+        return false;
+    }
 
     Utility::platformLog("Finished repacking files");
     LOG_TO_DEBUG("Finished repacking files");
@@ -710,11 +1065,17 @@ bool RandoSession::modFiles()
 void RandoSession::clearCache()
 {
     fileCache->children.clear();
+    entriesByHandle.clear(); //handles stay valid, they just point at fresh entries next time
     fileCache->dependents.clear();
     fileCache->data = nullptr;
     fileCache->actions.clear();
+    fileCache->actionKeys.clear();
     fileCache->numPrereqs = 0;
     
     total_num_tasks = 0;
     num_completed_tasks = 0;
+    tasks_failed = false;
+
+    queuedRoots.clear();
+    memoryInUse = 0;
 }
@@ -6,15 +6,40 @@
 #include <unordered_map>
 #include <functional>
 #include <atomic>
+#include <mutex>
+#include <deque>
+#include <type_traits>
+#include <optional>
+#include <limits>
+#include <cstdint>
 
 #include <utility/path.hpp>
 #include <filetypes/baseFiletype.hpp>
+#include <filetypes/yaz0.hpp>
+#include <command/DecodeCache.hpp>
+#include <command/OutputManifest.hpp>
+#include <command/OutputWriter.hpp>
 
 
 
-#define CAST_ENTRY_TO_FILETYPE(var, type, data)   \
-    if(dynamic_cast<type*>(data) == nullptr) return 0;  \
-    type& var = *dynamic_cast<type*>(data);
+namespace Utility {
+    class WorkStealingPool;
+}
+
+namespace FileTypes {
+    class BDTFile;
+    class FLIMFile;
+    class FLYTFile;
+    class resFile;
+    class ChartList;
+    class DZXFile;
+    class ELF;
+    class EventList;
+    class JPC;
+    class MSBPFile;
+    class MSBTFile;
+    class SARCFile;
+}
 
 class RandoSession
 {
@@ -41,7 +66,8 @@ public:
             EMPTY, //fileCache, no data
         };
         
-        CacheEntry(std::shared_ptr<CacheEntry> parent_, const fspath& elem_, const Format& format_) :
+        CacheEntry(RandoSession* session_, std::shared_ptr<CacheEntry> parent_, const fspath& elem_, const Format& format_) :
+            session(session_),
             parent(parent_),
             element(elem_),
             storedFormat(format_)
@@ -49,8 +75,19 @@ public:
 
         using Action_t = std::function<int(RandoSession*, FileType*)>;
 
-        void addAction(Action_t action);
+        void addAction(Action_t action); //uses the session's current action key
+        void addAction(Action_t action, const std::string& inputKey); //inputKey should identify everything the action's result depends on, empty if unknown
+
+        // Typed actions, T is checked against the entry's format once here instead of casting on every call
+        template<typename T, typename F> requires std::is_invocable_r_v<int, F&, RandoSession*, T&>
+        void addAction(F&& action);
+        template<typename T, typename F> requires std::is_invocable_r_v<int, F&, RandoSession*, T&>
+        void addAction(F&& action, const std::string& inputKey);
+
+        template<typename T>
+        static constexpr bool holdsType(const Format& format); //if entries of this format store their data as T
         void addDependent(std::shared_ptr<CacheEntry> depends); //add entry to tree after this one is completed, prevent repack-mod-repack
+        void setYaz0Profile(const FileTypes::Yaz0Profile& profile) { yaz0Profile = profile; } //only used by YAZ0 entries, overrides the session's profile
 
         size_t incrementPrereq() { return ++numPrereqs; }
         size_t decrementPrereq() { return --numPrereqs; }
@@ -62,6 +99,7 @@ public:
         bool isSibling(const std::shared_ptr<CacheEntry> other) const;
 
     private:
+        RandoSession* const session = nullptr;
         const std::shared_ptr<CacheEntry> parent = nullptr;
         std::unordered_map<std::string, std::shared_ptr<CacheEntry>> children = {}; //can't use CacheEntry directly, unordered_map needs complete type per the standard
         std::vector<std::shared_ptr<CacheEntry>> dependents = {};
@@ -70,37 +108,184 @@ public:
         const Format storedFormat = Format::EMPTY;
         std::unique_ptr<FileType> data = nullptr;
         std::vector<Action_t> actions = {}; //store actions as lambdas to execute in order
-        std::atomic<size_t> numPrereqs = 0;
+        std::vector<std::string> actionKeys = {}; //inputs each action depends on, used to skip unchanged files in incremental mode
+        std::string inputDigest = ""; //only set on roots, empty if the output can't be predicted
+        size_t memoryEstimate = 0; //only set on roots, rough peak bytes held while it's being repacked
+        std::optional<FileTypes::Yaz0Profile> yaz0Profile = std::nullopt;
+        std::vector<char> originalEncoded = {}; //only set on YAZ0, the compressed data it was extracted from
+        std::string decodedHash = ""; //only set on YAZ0, if the data still hashes the same the original can be reused
+        std::atomic<size_t> numPrereqs = 0; //while repacking this also holds 1 until the parent is extracted
+        std::atomic<size_t> pendingChildren = 0; //repacked once this reaches 0
+        std::mutex childMut; //children read from and write into this entry's data, only one at a time
         std::atomic<bool> finished = false;
     
+        void logTypeMismatch() const;
+
         friend class RandoSession;
     };
 
+    using PathHandle = uint32_t; //interned "@" path, stays valid for the whole program
+    static constexpr PathHandle NO_PATH = std::numeric_limits<PathHandle>::max(); //parent of the roots, resolves to fileCache instead of a file
+
     RandoSession();
 
     void setFirstTimeSetup(const bool& doSetup) { firstTimeSetup = doSetup; }
+    void setUseDecodeCache(const bool& useCache) { useDecodeCache = useCache; } //takes effect on init()
+    void setIncrementalOutput(const bool& incremental) { incrementalOutput = incremental; } //skip files whose inputs and output match the last run
+    void setActionKey(const std::string& key) { actionKey = key; } //applied to actions added without their own key, should identify what they depend on
+    void setMemoryBudget(const size_t& bytes) { memoryBudget = bytes; } //limits how many files are repacked at once, 0 for no limit
+    void setYaz0Profile(const FileTypes::Yaz0Profile& profile) { yaz0Profile = profile; } //default for YAZ0 entries without their own
+    void setNestedYaz0Profile(const std::optional<FileTypes::Yaz0Profile>& profile) { nestedYaz0Profile = profile; } //for YAZ0 files inside a SARC, ignored when the default is FAST
+    void setSyncOutput(const bool& sync) { outputWriter.setSyncOnFlush(sync); } //fsync output files once repacking is done
     bool init(const fspath& gameBaseDir, const fspath& randoOutputDir);
+    [[nodiscard]] PathHandle resolvePath(const fspath& relPath); //resolve once to skip parsing the path on every open
     [[nodiscard]] CacheEntry& openGameFile(const fspath& relPath);
+    [[nodiscard]] CacheEntry& openGameFile(const PathHandle& handle);
     [[nodiscard]] bool copyToGameFile(const fspath& source, const fspath& relPath, const bool& resourceFile = false);
     [[nodiscard]] bool restoreGameFile(const fspath& relPath);
     [[nodiscard]] bool modFiles();
 
     const fspath& getBaseDir() const { return baseDir; }
     const fspath& getOutputDir() const { return outputDir; }
+    Utility::WorkStealingPool* getWorkerPool() const; //for actions that want to split up their own work, safe to wait on from inside an action
 private:
-    std::shared_ptr<CacheEntry> getEntry(const std::vector<std::string>& fileSpec);
+    // One node per element of an interned path, the handle is its index
+    struct PathNode {
+        PathHandle parent;
+        std::string element;
+        std::string key; //key in the parent entry's children
+        CacheEntry::Format format;
+    };
+
+    std::shared_ptr<CacheEntry> getEntry(const PathHandle& handle);
+    // Each format has one codec, looked up by format instead of switching on it
+    struct Codec {
+        bool (RandoSession::*extract)(CacheEntry& current);
+        bool (RandoSession::*repack)(CacheEntry& current);
+    };
+    static const Codec& getCodec(const CacheEntry::Format& format);
+    static RawFile* getRawData(CacheEntry& entry); //nullptr if the entry's data isn't raw
+
+    template<typename T> bool extractParsed(CacheEntry& current);
+    template<typename T> bool repackParsed(CacheEntry& current);
+    bool extractSARC(CacheEntry& current);
+    bool extractRPX(CacheEntry& current);
+    bool repackRPX(CacheEntry& current);
+    bool extractYAZ0(CacheEntry& current);
+    bool repackYAZ0(CacheEntry& current);
+    bool extractStream(CacheEntry& current);
+    bool repackStream(CacheEntry& current);
+    bool extractRoot(CacheEntry& current);
+    bool repackRoot(CacheEntry& current);
+    bool repackUnsupported(CacheEntry& current);
+
     bool extractFile(std::shared_ptr<CacheEntry> current);
     bool repackFile(std::shared_ptr<CacheEntry> current);
-    bool handleChildren(const fspath filename, std::shared_ptr<CacheEntry> current);
+    void prepareEntry(const std::shared_ptr<CacheEntry> current);
+    void scheduleEntry(std::shared_ptr<CacheEntry> current);
+    void runEntry(std::shared_ptr<CacheEntry> current);
+    void runActions(std::shared_ptr<CacheEntry> current);
+    void finishEntry(std::shared_ptr<CacheEntry> current);
+    size_t estimateMemory(const std::shared_ptr<CacheEntry> root) const;
+    void startQueuedRoots(const bool& force = false);
+    std::string getInputDigest(const std::shared_ptr<CacheEntry> root) const;
+    bool appendDigestInput(std::string& out, const std::string& key, const CacheEntry& entry) const;
+    #ifdef ENABLE_TIMING
+        static std::string getFormatName(const CacheEntry::Format& format);
+        static std::string getTracePath(const CacheEntry& entry);
+    #endif
     void clearCache();
+    #ifndef DEVKITPRO
+        bool copyDump(); //copies everything modFiles won't write
+    #endif
     bool runFirstTimeSetup();
 
     bool firstTimeSetup = false;
+    #ifdef DEVKITPRO
+        bool useDecodeCache = false; //console storage is small and slow, decoding is faster than reading back a cache there
+    #else
+        bool useDecodeCache = true;
+    #endif
     bool initialized = false;
     fspath baseDir;
     fspath outputDir;
+    DecodeCache decodeCache;
+    #ifdef DEVKITPRO
+        bool incrementalOutput = false;
+    #else
+        bool incrementalOutput = true;
+    #endif
+    std::string actionKey = "";
+    FileTypes::Yaz0Profile yaz0Profile = FileTypes::Yaz0Profile::BALANCED;
+    std::optional<FileTypes::Yaz0Profile> nestedYaz0Profile = std::nullopt;
+    OutputManifest manifest;
+    size_t memoryBudget = 0;
+    OutputWriter outputWriter;
+    std::mutex rootQueueMut;
+    std::deque<std::shared_ptr<CacheEntry>> queuedRoots; //roots ready to go, waiting for memory
+    size_t memoryInUse = 0; //sum of estimates for running roots
     
-    std::shared_ptr<CacheEntry> fileCache = std::make_shared<CacheEntry>(nullptr, "", CacheEntry::Format::EMPTY);
+    std::vector<PathNode> pathNodes;
+    std::unordered_map<std::string, PathHandle> handlesByPath; //full "@" paths that have been resolved
+    std::unordered_map<std::string, PathHandle> handlesByKey; //cache key of each node
+    std::vector<std::shared_ptr<CacheEntry>> entriesByHandle; //entries in the current tree, cleared with it
+
+    std::shared_ptr<CacheEntry> fileCache = std::make_shared<CacheEntry>(this, nullptr, "", CacheEntry::Format::EMPTY);
 };
 
+template<typename T, typename F> requires std::is_invocable_r_v<int, F&, RandoSession*, T&>
+void RandoSession::CacheEntry::addAction(F&& action) {
+    addAction<T>(std::forward<F>(action), session->actionKey);
+}
+
+template<typename T, typename F> requires std::is_invocable_r_v<int, F&, RandoSession*, T&>
+void RandoSession::CacheEntry::addAction(F&& action, const std::string& inputKey) {
+    if(!holdsType<T>(storedFormat)) {
+        logTypeMismatch();
+        return;
+    }
+
+    addAction(Action_t([action = std::forward<F>(action)](RandoSession* session, FileType* data) mutable -> int {
+        return action(session, static_cast<T&>(*data));
+    }), inputKey);
+}
+
+template<typename T>
+constexpr bool RandoSession::CacheEntry::holdsType(const Format& format) {
+    switch(format) {
+        case Format::BDT:
+            return std::is_same_v<T, FileTypes::BDTFile>;
+        case Format::BFLIM:
+            return std::is_same_v<T, FileTypes::FLIMFile>;
+        case Format::BFLYT:
+            return std::is_same_v<T, FileTypes::FLYTFile>;
+        case Format::BFRES:
+            return std::is_same_v<T, FileTypes::resFile>;
+        case Format::CHARTS:
+            return std::is_same_v<T, FileTypes::ChartList>;
+        case Format::DZX:
+            return std::is_same_v<T, FileTypes::DZXFile>;
+        case Format::ELF:
+            return std::is_same_v<T, FileTypes::ELF>;
+        case Format::EVENTS:
+            return std::is_same_v<T, FileTypes::EventList>;
+        case Format::JPC:
+            return std::is_same_v<T, FileTypes::JPC>;
+        case Format::MSBP:
+            return std::is_same_v<T, FileTypes::MSBPFile>;
+        case Format::MSBT:
+            return std::is_same_v<T, FileTypes::MSBTFile>;
+        case Format::SARC:
+            return std::is_same_v<T, FileTypes::SARCFile>;
+        case Format::RPX:
+        case Format::YAZ0:
+        case Format::STREAM:
+        case Format::ROOT:
+            return std::is_same_v<T, RawFile>;
+        case Format::EMPTY:
+        default:
+            return false;
+    }
+}
+
 extern RandoSession g_session; //defined in RandoSession.cpp, shared between a couple files, set up in randomizer.cpp
@@ -0,0 +1,85 @@
+#include "Trace.hpp"
+
+#include <fstream>
+
+using namespace std::chrono;
+
+
+
+static std::string escapeJson(const std::string& str) {
+    std::string ret;
+    ret.reserve(str.size());
+    for(const char& c : str) {
+        switch(c) {
+            case '"':
+                ret += "\\\"";
+                break;
+            case '\\':
+                ret += "\\\\";
+                break;
+            case '\n':
+                ret += "\\n";
+                break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20) continue; //nothing we name should have these
+                ret += c;
+        }
+    }
+
+    return ret;
+}
+
+TraceLog::TraceLog() :
+    openTime(Clock_t::now())
+{}
+
+TraceLog& TraceLog::getInstance() {
+    static TraceLog s_Instance;
+    return s_Instance;
+}
+
+void TraceLog::addEvent(Event event) {
+    std::scoped_lock lock(eventMut);
+
+    //small sequential ids are easier to read in the viewer than hashed thread ids
+    const auto [it, inserted] = threadIndices.try_emplace(std::this_thread::get_id(), threadIndices.size());
+    events.emplace_back(it->second, std::move(event));
+}
+
+bool TraceLog::write() {
+    std::scoped_lock lock(eventMut);
+
+    std::ofstream output(LOG_PATH);
+    if(!output.is_open()) return false;
+
+    output << "{\"traceEvents\":[";
+    for(size_t i = 0; i < events.size(); i++) {
+        const auto& [thread, event] = events[i];
+        const auto start = duration_cast<microseconds>(event.start - openTime).count();
+        const auto duration = duration_cast<microseconds>(event.end - event.start).count();
+
+        output << (i == 0 ? "\n" : ",\n");
+        output << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.format << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread;
+        output << ",\"ts\":" << start << ",\"dur\":" << duration;
+        output << ",\"args\":{\"path\":\"" << escapeJson(event.path) << "\",\"format\":\"" << event.format << "\",\"bytes_in\":" << event.bytesIn << ",\"bytes_out\":" << event.bytesOut << "}}";
+    }
+    output << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    events.clear();
+    return output.good();
+}
+
+
+
+ScopedTrace::ScopedTrace(const std::string& name, const std::string& path, const std::string& format, const size_t& bytesIn) {
+    event.name = name;
+    event.path = path;
+    event.format = format;
+    event.bytesIn = bytesIn;
+    event.start = TraceLog::Clock_t::now();
+}
+
+ScopedTrace::~ScopedTrace() {
+    event.end = TraceLog::Clock_t::now();
+    TraceLog::getInstance().addEvent(std::move(event));
+}
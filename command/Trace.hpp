@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+
+#include <utility/path.hpp>
+
+
+
+// Collects per-file events and writes them in the Chrome trace format (chrome://tracing, ui.perfetto.dev)
+class TraceLog {
+public:
+    using Clock_t = std::chrono::steady_clock;
+
+    struct Event {
+        std::string name;
+        std::string path;
+        std::string format;
+        Clock_t::time_point start;
+        Clock_t::time_point end;
+        size_t bytesIn = 0;
+        size_t bytesOut = 0;
+    };
+
+private:
+    const Clock_t::time_point openTime;
+    std::mutex eventMut;
+    std::vector<std::pair<size_t, Event>> events; //thread index, event
+    std::unordered_map<std::thread::id, size_t> threadIndices;
+
+    TraceLog();
+    ~TraceLog() = default;
+
+public:
+    const fspath LOG_PATH = Utility::get_app_save_path() / "Trace.json";
+
+    TraceLog(const TraceLog&) = delete;
+    TraceLog& operator=(const TraceLog&) = delete;
+
+    static TraceLog& getInstance();
+    void addEvent(Event event);
+    bool write(); //writes everything recorded so far and clears it
+};
+
+// Records an event covering its lifetime
+class ScopedTrace {
+private:
+    TraceLog::Event event;
+
+public:
+    ScopedTrace(const std::string& name, const std::string& path, const std::string& format, const size_t& bytesIn = 0);
+    ~ScopedTrace();
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+    void setBytesIn(const size_t& bytes) { event.bytesIn = bytes; }
+    void setBytesOut(const size_t& bytes) { event.bytesOut = bytes; }
+};
@@ -34,9 +34,8 @@ bool writeCharts(const WorldPool& worlds) {
         const fspath dzrPath = getRoomDzrPath("sea", islandNumber);
         RandoSession::CacheEntry& dzrEntry = g_session.openGameFile(dzrPath);
 
-        entry.addAction([&worlds, &dzrEntry, islandNumber](RandoSession* session, FileType* data) -> int
+        entry.addAction<FileTypes::ChartList>([&worlds, &dzrEntry, islandNumber](RandoSession* session, FileTypes::ChartList& charts) -> int
         {
-            CAST_ENTRY_TO_FILETYPE(charts, FileTypes::ChartList, data)
             static const auto original_charts = charts.charts;
 
             const Chart& original_chart = *std::find_if(original_charts.begin(), original_charts.end(), [islandNumber](const Chart& chart) { return (chart.type == 0 || chart.type == 1 || chart.type == 2 || chart.type == 5 || chart.type == 6 || chart.type == 8) && chart.getIslandNumber() == islandNumber; });
@@ -58,9 +57,8 @@ bool writeCharts(const WorldPool& worlds) {
                 new_pos.salvage_y_pos = original_pos.salvage_y_pos;
             }
 
-            dzrEntry.addAction([new_chart = *new_chart](RandoSession* session, FileType* data) -> int
+            dzrEntry.addAction<FileTypes::DZXFile>([new_chart = *new_chart](RandoSession* session, FileTypes::DZXFile& dzr) -> int
             {
-                CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
 
                 for(ChunkEntry* scob : dzr.entries_by_type("SCOB")) {
                     if(salvage_object_names.count(scob->data.substr(0, 8)) > 0 && ((scob->data[8] & 0xF0) >> 4) == 0) {
@@ -71,8 +71,7 @@ bool writeEntrances(WorldPool& worlds) {
         if (replacementStage == "MiniKaz" || replacementStage == "MiniHyo") {
             const fspath exitFilepath = getRoomDzrPath(replacementStage, replacementRoom);
             RandoSession::CacheEntry& exitDzrEntry = g_session.openGameFile(exitFilepath);
-            exitDzrEntry.addAction([entrance, replacementStage](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+            exitDzrEntry.addAction<FileTypes::DZXFile>([entrance, replacementStage](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
                 // Get the "VolTag" actor (otherwise known as the kill trigger)
                 const std::vector<ChunkEntry*> actors = dzr.entries_by_type("ACTR");
@@ -107,9 +106,8 @@ bool writeEntrances(WorldPool& worlds) {
         if (sclsExitIndex != 0xFF)
         {
             RandoSession::CacheEntry& dzrEntry = g_session.openGameFile(filepath);
-            dzrEntry.addAction([fileStage, sclsExitIndex, replacementStage, replacementRoom, replacementSpawn](RandoSession* session, FileType* data) mutable -> int
+            dzrEntry.addAction<FileTypes::DZXFile>([fileStage, sclsExitIndex, replacementStage, replacementRoom, replacementSpawn](RandoSession* session, FileTypes::DZXFile& dzr) mutable -> int
             {
-                CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
 
                 const std::vector<ChunkEntry*> scls_entries = dzr.entries_by_type("SCLS");
                 if(sclsExitIndex > (scls_entries.size() - 1)) {
@@ -134,9 +132,8 @@ bool writeEntrances(WorldPool& worlds) {
             filepath = getStageFilePath(fileStage).concat("@YAZ0@SARC@Stage.bfres@BFRES@stage.dzs@DZX");
             RandoSession::CacheEntry& dzsEntry = g_session.openGameFile(filepath);
             //sclsExitIndex = 0;
-            dzsEntry.addAction([fileStage, entrance, replacementStage, replacementRoom, replacementSpawn](RandoSession* session, FileType* data) mutable -> int
+            dzsEntry.addAction<FileTypes::DZXFile>([fileStage, entrance, replacementStage, replacementRoom, replacementSpawn](RandoSession* session, FileTypes::DZXFile& dzr) mutable -> int
             {
-                CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
 
                 // If this boss/miniboss room is accessed via a dungeon then set the savewarp
                 // as the dungeon entrance
@@ -237,8 +234,7 @@ bool writeEntrances(WorldPool& worlds) {
 
         const fspath filepath = getStageFilePath(entrance->getFilepathStage()).concat("@YAZ0@SARC@Stage.bfres@BFRES@event_list.dat@EVENTS");
         RandoSession::CacheEntry& list = g_session.openGameFile(filepath);
-        list.addAction([filepath, replacementRoom, replacementSpawn, replacementStage](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(event_list, FileTypes::EventList, data)
+        list.addAction<FileTypes::EventList>([filepath, replacementRoom, replacementSpawn, replacementStage](RandoSession* session, FileTypes::EventList& event_list) -> int {
 
             if(event_list.Events_By_Name.count("WARP_WIND_AFTER") == 0) {
                 ErrorLog::getInstance().log("No Event WARP_WIND_AFTER in " + filepath.string());
@@ -8,6 +8,7 @@
 #include <utility/file.hpp>
 #include <utility/platform.hpp>
 #include <filetypes/util/elfUtil.hpp>
+#include <filetypes/util/elfPatch.hpp>
 #include <command/RandoSession.hpp>
 #include <command/WWHDStructs.hpp>
 #include <command/Log.hpp>
@@ -59,18 +60,12 @@ namespace {
     static std::unordered_map<std::string, uint32_t> custom_symbols;
 
     void Load_Custom_Symbols(const fspath& file_path) {
-        std::string file_data;
-        if(Utility::getFileContents(file_path, file_data, true))
+        if(elfPatch::loadSymbols(file_path, custom_symbols) != PatchError::NONE)
         {
             ErrorLog::getInstance().log("ERROR: Failed to load custom symbols when saving items");
             return;
         }
 
-        YAML::Node symbols = YAML::Load(file_data);
-        for (const auto& symbol : symbols) {
-            custom_symbols[symbol.first.as<std::string>()] = symbol.second.as<uint32_t>();
-        }
-
         return;
     }
 }
@@ -103,7 +98,7 @@ ModificationError ModifyChest::parseArgs(const YAML::Node& locationObject) {
     if(!locationObject["Path"]) {
         LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
     }
-    filePath = locationObject["Path"].as<std::string>();
+    fileHandle = g_session.resolvePath(locationObject["Path"].as<std::string>());
 
     if(!locationObject["Offsets"].IsSequence()) {
         LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
@@ -117,11 +112,12 @@ ModificationError ModifyChest::parseArgs(const YAML::Node& locationObject) {
 }
 
 ModificationError ModifyChest::writeLocation(const Item& item) {
-    RandoSession::CacheEntry& file = g_session.openGameFile(filePath);
-    file.addAction([this, item](RandoSession* session, FileType* data) -> int {
+    // parseArgs failed or never ran, don't add the actions to some other file
+    if(fileHandle == RandoSession::NO_PATH) LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
+    RandoSession::CacheEntry& file = g_session.openGameFile(fileHandle);
+    file.addAction<RawFile>([this, item](RandoSession* session, RawFile& generic) -> int {
         for (const uint32_t& offset : this->offsets) {
-            CAST_ENTRY_TO_FILETYPE(generic, RawFile, data)
-            std::stringstream& stream = generic.data;
+            Utility::ByteStream& stream = generic.data;
 
             stream.seekg(offset, std::ios::beg);
             ACTR chest = WWHDStructs::readACTR(stream);
@@ -182,7 +178,7 @@ ModificationError ModifyActor::parseArgs(const YAML::Node& locationObject) {
     if(!locationObject["Path"]) {
         LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
     }
-    filePath = locationObject["Path"].as<std::string>();
+    fileHandle = g_session.resolvePath(locationObject["Path"].as<std::string>());
 
     if(!locationObject["Offsets"].IsSequence()) {
         LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
@@ -196,10 +192,10 @@ ModificationError ModifyActor::parseArgs(const YAML::Node& locationObject) {
 }
 
 ModificationError ModifyActor::writeLocation(const Item& item) {
-    RandoSession::CacheEntry& file = g_session.openGameFile(filePath);
-    file.addAction([this, item](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data)
-        std::stringstream& stream = generic.data;
+    if(fileHandle == RandoSession::NO_PATH) LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
+    RandoSession::CacheEntry& file = g_session.openGameFile(fileHandle);
+    file.addAction<RawFile>([this, item](RandoSession* session, RawFile& generic) -> int {
+        Utility::ByteStream& stream = generic.data;
 
         for (const uint32_t& offset : this->offsets) {
             stream.seekg(offset, std::ios::beg);
@@ -249,7 +245,7 @@ ModificationError ModifySCOB::parseArgs(const YAML::Node& locationObject) {
     if(!locationObject["Path"]) {
         LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
     }
-    filePath = locationObject["Path"].as<std::string>();
+    fileHandle = g_session.resolvePath(locationObject["Path"].as<std::string>());
 
     if(!locationObject["Offsets"].IsSequence()) {
         LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
@@ -263,10 +259,10 @@ ModificationError ModifySCOB::parseArgs(const YAML::Node& locationObject) {
 }
 
 ModificationError ModifySCOB::writeLocation(const Item& item) {
-    RandoSession::CacheEntry& file = g_session.openGameFile(filePath);
-    file.addAction([this, item](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data)
-        std::stringstream& stream = generic.data;
+    if(fileHandle == RandoSession::NO_PATH) LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
+    RandoSession::CacheEntry& file = g_session.openGameFile(fileHandle);
+    file.addAction<RawFile>([this, item](RandoSession* session, RawFile& generic) -> int {
+        Utility::ByteStream& stream = generic.data;
 
         for (const uint32_t& offset : this->offsets) {
             stream.seekg(offset, std::ios::beg);
@@ -292,7 +288,7 @@ ModificationError ModifyEvent::parseArgs(const YAML::Node& locationObject) {
     if(!locationObject["Path"]) {
         LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
     }
-    filePath = locationObject["Path"].as<std::string>();
+    fileHandle = g_session.resolvePath(locationObject["Path"].as<std::string>());
 
     if(!locationObject["Offset"]) {
         LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
@@ -308,10 +304,10 @@ ModificationError ModifyEvent::parseArgs(const YAML::Node& locationObject) {
 }
 
 ModificationError ModifyEvent::writeLocation(const Item& item) {
-    RandoSession::CacheEntry& file = g_session.openGameFile(filePath);
-    file.addAction([this, item](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data)
-        std::stringstream& stream = generic.data;
+    if(fileHandle == RandoSession::NO_PATH) LOG_ERR_AND_RETURN(ModificationError::MISSING_KEY);
+    RandoSession::CacheEntry& file = g_session.openGameFile(fileHandle);
+    file.addAction<RawFile>([this, item](RandoSession* session, RawFile& generic) -> int {
+        Utility::ByteStream& stream = generic.data;
         
         uint8_t itemID = static_cast<uint8_t>(item.getGameItemId());
     
@@ -351,8 +347,7 @@ ModificationError ModifyRPX::writeLocation(const Item& item) {
     uint8_t itemID = static_cast<uint8_t>(item.getGameItemId());
 
     RandoSession::CacheEntry& file = g_session.openGameFile("code/cking.rpx@RPX@ELF");
-    file.addAction([this, itemID](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data);
+    file.addAction<FileTypes::ELF>([this, itemID](RandoSession* session, FileTypes::ELF& elf) -> int {
         
         for (const uint32_t& address : this->offsets) {
             if(const auto& err = elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, address), itemID); err != ELFError::NONE) {
@@ -380,7 +375,7 @@ ModificationError ModifySymbol::parseArgs(const YAML::Node& locationObject) {
 }
 
 ModificationError ModifySymbol::writeLocation(const Item& item) {
-    if (custom_symbols.size() == 0) Load_Custom_Symbols(Utility::get_data_path() / "asm/custom_symbols.yaml");
+    if (custom_symbols.size() == 0) Load_Custom_Symbols(Utility::get_data_path() / "asm/custom_symbols.bin");
 
     for(const auto& symbol : symbolNames) {
         uint32_t address;
@@ -400,8 +395,7 @@ ModificationError ModifySymbol::writeLocation(const Item& item) {
         }
 
         RandoSession::CacheEntry& file = g_session.openGameFile("code/cking.rpx@RPX@ELF");
-        file.addAction([address, itemID](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data);
+        file.addAction<FileTypes::ELF>([address, itemID](RandoSession* session, FileTypes::ELF& elf) -> int {
 
             if(const auto& err = elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, address), itemID); err != ELFError::NONE) {
                 LOG_ERR_AND_RETURN_BOOL(ModificationError::RPX_ERROR);
@@ -434,8 +428,7 @@ ModificationError ModifyBoss::writeLocation(const Item& item) {
 
         if (path == "code/cking.rpx@RPX@ELF") {
             RandoSession::CacheEntry& rpx = g_session.openGameFile("code/cking.rpx@RPX@ELF");
-            rpx.addAction([offset = offset, itemID](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+            rpx.addAction<FileTypes::ELF>([offset = offset, itemID](RandoSession* session, FileTypes::ELF& elf) -> int {
 
                 if(const auto& err = elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, offset), itemID); err != ELFError::NONE) {
                     LOG_ERR_AND_RETURN_BOOL(ModificationError::RPX_ERROR);
@@ -448,9 +441,8 @@ ModificationError ModifyBoss::writeLocation(const Item& item) {
         }
         else {
             RandoSession::CacheEntry& file = g_session.openGameFile(path);
-            file.addAction([offset = offset, itemID](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(generic, RawFile, data)
-                std::stringstream& stream = generic.data;
+            file.addAction<RawFile>([offset = offset, itemID](RandoSession* session, RawFile& generic) -> int {
+                Utility::ByteStream& stream = generic.data;
                 
                 stream.seekg(offset, std::ios::beg);
                 ACTR actor = WWHDStructs::readACTR(stream);
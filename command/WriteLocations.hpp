@@ -49,7 +49,7 @@ private:
     inline static std::map<std::string, Dungeon> dungeons = {};
     inline static std::list<Location*> playthroughLocations = {};
 
-    fspath filePath;
+    RandoSession::PathHandle fileHandle = RandoSession::NO_PATH; //resolved when parsed, the same files are opened for many locations
     std::vector<uint32_t> offsets;
 
     ModificationError setCTMCType(ACTR& chest, const Item& item);
@@ -70,7 +70,7 @@ public:
 
 class ModifyActor final : public LocationModification {
 private:
-    fspath filePath;
+    RandoSession::PathHandle fileHandle = RandoSession::NO_PATH;
     std::vector<uint32_t> offsets;
 
 public:
@@ -88,7 +88,7 @@ public:
 
 class ModifySCOB final : public LocationModification {
 private:
-    fspath filePath;
+    RandoSession::PathHandle fileHandle = RandoSession::NO_PATH;
     std::vector<uint32_t> offsets;
 
 public:
@@ -106,7 +106,7 @@ public:
 
 class ModifyEvent final : public LocationModification {
 private:
-    fspath filePath;
+    RandoSession::PathHandle fileHandle = RandoSession::NO_PATH;
     uint32_t offset;
     uint32_t nameOffset;
 
@@ -1,13 +1,16 @@
 #include "model.hpp"
 
-#include <tuple>
+#include <algorithm>
+#include <string_view>
+
+#include "recolor.hpp"
 
 #include <libs/yaml.hpp>
-#include <logic/PoolFunctions.hpp>
 #include <utility/endian.hpp>
 #include <utility/color.hpp>
 #include <utility/file.hpp>
 #include <utility/platform.hpp>
+#include <utility/work_pool.hpp>
 #include <filetypes/bfres.hpp>
 #include <filetypes/baseFiletype.hpp>
 #include <filetypes/sarc.hpp>
@@ -253,14 +256,9 @@ static const std::unordered_map<std::string, std::list<std::string>> casualTextu
 // IMPROVEMENT: Better generalize this in the future
 ModelError CustomModel::applyModel() const {
     RandoSession::CacheEntry& link = g_session.openGameFile("content/Common/Pack/permanent_3d.pack@SARC@Link.szs@YAZ0@SARC@Link.bfres@BFRES");
-    link.addAction([&](RandoSession* session, FileType* data) -> int {
+    link.addAction<FileTypes::resFile>([&](RandoSession* session, FileTypes::resFile& bfres) -> int {
         Utility::platformLog("guess not");
 
-        CAST_ENTRY_TO_FILETYPE(bfres, FileTypes::resFile, data)
-
-        std::string maskFile = "";
-        uint16_t baseColor = 0;
-        uint16_t replacementColor = 0;
 
         auto baseColors = getDefaultColorsMap();
         std::unordered_map<std::string, std::list<std::string>> textureMappings = {};
@@ -270,122 +268,75 @@ ModelError CustomModel::applyModel() const {
             textureMappings = heroTextureMappings;
         }
 
-        for (FileTypes::Subfiles::FTEXFile& texture : bfres.textures) {
-            for (auto& [name, textureNames] : textureMappings) {
-                replacementColor = hexColorStrTo16Bit(getColor(name));
-                baseColor = hexColorStrTo16Bit(baseColors[name]);
+        // Build one exchange table per color, every texture using that color shares it
+        // References into the map stay valid as it grows, so the tables can be filled in parallel
+        std::unordered_map<std::string, ColorExchangeTable> exchangeTables = {};
+        std::vector<Utility::WorkStealingPool::Task_t> tasks;
+        for (auto& [name, textureNames] : textureMappings) {
+            const uint16_t baseColor = hexColorStrTo16Bit(baseColors[name]);
+            const uint16_t replacementColor = hexColorStrTo16Bit(getColor(name));
+
+            // Don't modify colors if it's not necessary
+            if (baseColor == replacementColor) {
+                continue;
+            }
 
-                // Don't modify colors if it's not necessary
-                if (baseColor == replacementColor) {
-                    continue;
-                }
+            ColorExchangeTable& table = exchangeTables[name];
+            tasks.emplace_back([&table, baseColor, replacementColor]() {
+                buildColorExchangeTable(baseColor, replacementColor, table);
+            });
+        }
+        Utility::runTasks(tasks, session->getWorkerPool());
 
-                for (std::string& textureName : textureNames) {
-                    if (texture.name.substr(0, textureName.length()) == textureName) {
-                        // Get the data from the mask file
-                        const std::string filename = (casual ? "casual" : "hero") + name + "_" + textureName + "_mask.bftex";
+        // Each texture only touches its own data
+        for (size_t textureIndex = 0; textureIndex < bfres.textures.size(); textureIndex++) {
+            tasks.emplace_back([&, textureIndex]() {
+                FileTypes::Subfiles::FTEXFile& texture = bfres.textures[textureIndex];
+                std::string maskFile = "";
 
-                        if (Utility::getFileContents(folder / "color_masks" / filename, maskFile, true) != 0) {
-                            Utility::platformLog("Could not open " + filename + " mask file. Will skip recoloring " + name);
-                            continue;
-                        }
+                for (auto& [name, textureNames] : textureMappings) {
+                    if (!exchangeTables.contains(name)) {
+                        continue;
+                    }
 
-                        // Textures are stored using various BCn compression formats
+                    for (std::string& textureName : textureNames) {
+                        if (texture.name.substr(0, textureName.length()) == textureName) {
+                            // Get the data from the mask file
+                            const std::string filename = (casual ? "casual" : "hero") + name + "_" + textureName + "_mask.bftex";
 
-                        // Actual texture data doesn't start until 0x2000, so remove
-                        // everything before that
-                        maskFile = maskFile.substr(0x2000);
-                        for (size_t i = 0; i < maskFile.length(); i += 8) {
-                            // Skip over alpha data in BC3 format
-                            if (texture.format == GX2_SURFACE_FORMAT_SRGB_BC3) {
-                                i += 8;
+                            if (Utility::getFileContents(folder / "color_masks" / filename, maskFile, true) != 0) {
+                                Utility::platformLog("Could not open " + filename + " mask file. Will skip recoloring " + name);
+                                continue;
                             }
 
+                            // Textures are stored using various BCn compression formats
+                            // BC3 blocks have alpha data before the color data that gets skipped over
+                            const Recolor::BlockLayout& layout = texture.format == GX2_SURFACE_FORMAT_SRGB_BC3 ? Recolor::BC3_LAYOUT : Recolor::BC1_LAYOUT;
+
+                            // Actual texture data doesn't start until 0x2000, so skip
+                            // everything before that
                             // The mask file color tells us if this is a color we should
                             // replace or not in the current texture
-                            const uint16_t maskColor1  = Utility::Endian::toPlatform(eType::Big, *(uint16_t*)&maskFile[i]);
-                            const uint16_t maskColor2  = Utility::Endian::toPlatform(eType::Big, *(uint16_t*)&maskFile[i + 2]);
+                            const Recolor::BlockMask mask = Recolor::buildBlockMask(std::string_view(maskFile).substr(std::min<size_t>(0x2000, maskFile.size())), layout);
 
-                            uint16_t texColor1;
-                            uint16_t texColor2;
+                            // TEMP FIX: Remove red from really dark base eye colors, otherwise
+                            // we can get some really light colors back that look weird
+                            const Recolor::Exchange exchange = {exchangeTables.at(name), name == "Eyes"};
 
-                            // The most defined texture data is stored in texture.data
-                            // All smaller mipmaps are stored in texture.mipData
-                            // Using little endian here is intentional
-                            if (i < texture.data.length()) {
-                                texColor1  = Utility::Endian::toPlatform(eType::Little, *(uint16_t*)&texture.data[i]);
-                                texColor2  = Utility::Endian::toPlatform(eType::Little, *(uint16_t*)&texture.data[i + 2]);
-                            } else if (i >= texture.data.length() && i < texture.data.length() + texture.mipData.length()) {
-                                texColor1  = Utility::Endian::toPlatform(eType::Little, *(uint16_t*)&texture.mipData[i - texture.data.length()]);
-                                texColor2  = Utility::Endian::toPlatform(eType::Little, *(uint16_t*)&texture.mipData[i + 2 - texture.data.length()]);
-                            }
-
-                            std::list<std::tuple<uint16_t, size_t, uint16_t>> masksOffsetsColors = {{maskColor1, i, texColor1} , {maskColor2, i + 2, texColor2}};
-
-                            // For the two colors in this iteration
-                            for (auto& [mask, offset, curColor] : masksOffsetsColors) {
-                                if (mask == 0x00F8) {
-                                    // TEMP FIX: Remove red from really dark base eye colors, otherwise
-                                    // we can get some really light colors back that look weird
-                                    if (name == "Eyes") {
-                                        curColor &= 0x07FF;
-                                    }
-
-                                    uint16_t newColor = colorExchange(baseColor, replacementColor, curColor);
-                                    Utility::Endian::toPlatform_inplace(eType::Little, newColor);
-
-                                    if (offset < texture.data.length()) {
-                                        texture.data.replace(offset, 2, reinterpret_cast<const char*>(&newColor), 2);
-                                    } else if (i >= texture.data.length() && i < texture.data.length() + texture.mipData.length()) {
-                                        texture.mipData.replace(offset - texture.data.length(), 2, reinterpret_cast<const char*>(&newColor), 2);
-                                    }
-                                }
-                            }
-
-                            // Check and potentially change pixel indices to avoid 
+                            // Check and potentially change pixel indices to avoid
                             // accidental transparent colors in BC1 format
-                            if (isAnyOf(0xF8, maskColor1, maskColor2) && texture.format == GX2_SURFACE_FORMAT_SRGB_BC1) {
-                                uint16_t newColor1 = 0;
-                                uint16_t newColor2 = 0;
-                                uint32_t indices = 0;
-                                uint32_t newIndices = 0;
-
-                                if (i < texture.data.length()) {
-                                    newColor1 = Utility::Endian::toPlatform(eType::Little, *(uint16_t*)&texture.data[i]);
-                                    newColor2 = Utility::Endian::toPlatform(eType::Little, *(uint16_t*)&texture.data[i + 2]);
-                                    indices   = Utility::Endian::toPlatform(eType::Little, *(uint32_t*)&texture.data[i + 4]);
-                                } else if (i >= texture.data.length() && i < texture.data.length() + texture.mipData.length()) {
-                                    newColor1 = Utility::Endian::toPlatform(eType::Little, *(uint16_t*)&texture.mipData[i - texture.data.length()]);
-                                    newColor2 = Utility::Endian::toPlatform(eType::Little, *(uint16_t*)&texture.mipData[i + 2 - texture.data.length()]);
-                                    indices   = Utility::Endian::toPlatform(eType::Little, *(uint32_t*)&texture.mipData[i + 4 - texture.data.length()]);
-                                }
-
-                                // If the first color is less than the second color,
-                                // change any pixels using index 3 to use index 2. Index
-                                // 3 in this case is used to denote transparent pixels
-                                if (newColor1 <= newColor2 && texColor1 > texColor2) {
-
-                                    for (size_t j = 0; j < 32; j += 2) {
-
-                                        uint32_t curIndex = (indices & (0b11 << j)) >> j;
-                                        if (curIndex == 3) {
-                                            curIndex = 2;
-                                        }
-                                        newIndices |= (curIndex << j);
-                                    }
-
-                                    if (i < texture.data.length()) {
-                                        texture.data.replace(i + 4, 4, reinterpret_cast<const char*>(&newIndices), 4);
-                                    } else if (i >= texture.data.length() && i < texture.data.length() + texture.mipData.length()) {
-                                        texture.mipData.replace(i + 4 - texture.data.length(), 4, reinterpret_cast<const char*>(&newIndices), 4);
-                                    }
-                                }
-                            }
+                            const bool fixBC1Indices = texture.format == GX2_SURFACE_FORMAT_SRGB_BC1;
+
+                            // The most defined texture data is stored in texture.data
+                            // All smaller mipmaps are stored in texture.mipData, the mask covers both
+                            Recolor::recolorBlocks(texture.data, mask, 0, layout, fixBC1Indices, exchange);
+                            Recolor::recolorBlocks(texture.mipData, mask, texture.data.size() / layout.stride, layout, fixBC1Indices, exchange);
                         }
                     }
                 }
-            }
+            });
         }
+        Utility::runTasks(tasks, session->getWorkerPool());
 
         return true;
     });
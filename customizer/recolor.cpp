@@ -0,0 +1,143 @@
+#include "recolor.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <utility/endian.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define RECOLOR_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    #define RECOLOR_NEON
+    #include <arm_neon.h>
+#endif
+
+using eType = Utility::Endian::Type;
+
+
+
+namespace {
+    // Endpoints stored as 00 F8 in the mask file are the ones to recolor
+    constexpr uint8_t MASK_BYTES[2] = {0x00, 0xF8};
+
+    template<typename T>
+    T readLE(const char* ptr) {
+        T value;
+        std::memcpy(&value, ptr, sizeof(T));
+        return Utility::Endian::toPlatform(eType::Little, value);
+    }
+
+    template<typename T>
+    void writeLE(char* ptr, T value) {
+        value = Utility::Endian::toPlatform(eType::Little, value);
+        std::memcpy(ptr, &value, sizeof(T));
+    }
+
+    uint8_t maskEndpoints(const char* color) {
+        const bool first = std::memcmp(color, MASK_BYTES, 2) == 0;
+        const bool second = std::memcmp(color + 2, MASK_BYTES, 2) == 0;
+        return first | (second << 1);
+    }
+
+    // Compares a whole vector of mask data at once, returns how many blocks that covered
+    size_t scanVector(const char* data, const Recolor::BlockLayout& layout, uint8_t* out) {
+        const size_t numBlocks = 16 / layout.stride;
+
+        #if defined(RECOLOR_SSE2)
+            const __m128i pattern = _mm_set1_epi16(static_cast<short>(MASK_BYTES[0] | (MASK_BYTES[1] << 8)));
+            const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            const uint32_t matches = _mm_movemask_epi8(_mm_cmpeq_epi16(values, pattern)); // 2 bits per 16-bit lane
+
+            for(size_t block = 0; block < numBlocks; block++) {
+                const size_t lane = (block * layout.stride + layout.colorOffset) / 2;
+                out[block] = ((matches >> (lane * 2)) & 1) | ((matches >> (lane * 2 + 1)) & 2);
+            }
+        #elif defined(RECOLOR_NEON)
+            const uint16x8_t pattern = vdupq_n_u16(MASK_BYTES[0] | (MASK_BYTES[1] << 8));
+            const uint16x8_t values = vld1q_u16(reinterpret_cast<const uint16_t*>(data));
+            uint8_t matches[8];
+            vst1_u8(matches, vmovn_u16(vceqq_u16(values, pattern)));
+
+            for(size_t block = 0; block < numBlocks; block++) {
+                const size_t lane = (block * layout.stride + layout.colorOffset) / 2;
+                out[block] = (matches[lane] & 1) | (matches[lane + 1] & 2);
+            }
+        #else
+            for(size_t block = 0; block < numBlocks; block++) {
+                out[block] = maskEndpoints(data + block * layout.stride + layout.colorOffset);
+            }
+        #endif
+
+        return numBlocks;
+    }
+
+    // Any index of 3 becomes 2, 3 is transparent when the first endpoint isn't the larger one
+    uint32_t removeTransparentIndices(const uint32_t& indices) {
+        return indices & ~((indices >> 1) & indices & 0x55555555);
+    }
+}
+
+namespace Recolor {
+    BlockMask buildBlockMask(std::string_view mask, const BlockLayout& layout) {
+        BlockMask out;
+        out.numBlocks = mask.size() / layout.stride;
+        out.bits.resize((out.numBlocks + 31) / 32, 0);
+
+        uint8_t endpoints[16 / sizeof(uint16_t)];
+        size_t block = 0;
+        while(block < out.numBlocks) {
+            size_t scanned = 1;
+            if(block * layout.stride + 16 <= mask.size()) {
+                scanned = scanVector(mask.data() + block * layout.stride, layout, endpoints);
+            }
+            else {
+                endpoints[0] = maskEndpoints(mask.data() + block * layout.stride + layout.colorOffset);
+            }
+
+            for(size_t i = 0; i < scanned && block < out.numBlocks; i++, block++) {
+                out.bits[block / 32] |= static_cast<uint64_t>(endpoints[i]) << (block % 32 * 2);
+            }
+        }
+
+        return out;
+    }
+
+    void recolorBlocks(std::string& data, const BlockMask& mask, const size_t& firstBlock, const BlockLayout& layout, const bool& fixBC1Indices, const Exchange& exchange) {
+        if(firstBlock >= mask.numBlocks) return;
+        const size_t numBlocks = std::min(data.size() / layout.stride, mask.numBlocks - firstBlock);
+
+        size_t block = 0;
+        while(block < numBlocks) {
+            // skip ahead to the next word when nothing else in this one is marked
+            const size_t maskBlock = firstBlock + block;
+            if((mask.bits[maskBlock / 32] >> (maskBlock % 32 * 2)) == 0) {
+                block += 32 - maskBlock % 32;
+                continue;
+            }
+
+            const uint8_t endpoints = mask.get(maskBlock);
+            if(endpoints != 0) {
+                char* color = data.data() + block * layout.stride + layout.colorOffset;
+                const uint16_t color1 = readLE<uint16_t>(color);
+                const uint16_t color2 = readLE<uint16_t>(color + 2);
+
+                uint16_t newColor1 = color1, newColor2 = color2;
+                if(endpoints & 1) {
+                    newColor1 = exchange.table[exchange.clearRed ? color1 & 0x07FF : color1];
+                    writeLE(color, newColor1);
+                }
+                if(endpoints & 2) {
+                    newColor2 = exchange.table[exchange.clearRed ? color2 & 0x07FF : color2];
+                    writeLE(color + 2, newColor2);
+                }
+
+                if(fixBC1Indices && newColor1 <= newColor2 && color1 > color2) {
+                    writeLE(color + 4, removeTransparentIndices(readLE<uint32_t>(color + 4)));
+                }
+            }
+
+            block++;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+//Recolors BCn texture blocks against the customizer's color masks
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <utility/color.hpp>
+
+namespace Recolor {
+    // Where the color endpoints are in each compressed block
+    struct BlockLayout {
+        size_t stride;      // bytes per block
+        size_t colorOffset; // BC3 stores its alpha data before the color data
+    };
+
+    constexpr BlockLayout BC1_LAYOUT = {8, 0};
+    constexpr BlockLayout BC3_LAYOUT = {16, 8};
+
+    // 2 bits per block, one for each endpoint the mask marks for recoloring
+    struct BlockMask {
+        std::vector<uint64_t> bits;
+        size_t numBlocks = 0;
+
+        uint8_t get(const size_t& block) const {
+            return (bits[block / 32] >> (block % 32 * 2)) & 0b11;
+        }
+    };
+
+    BlockMask buildBlockMask(std::string_view mask, const BlockLayout& layout);
+
+    struct Exchange {
+        const ColorExchangeTable& table;
+        bool clearRed; // drop red from the current color before looking it up
+    };
+
+    // firstBlock is the mask index of the first block in data, so mip data can be passed separately
+    // fixBC1Indices stops recolored BC1 blocks from switching to the mode with transparent pixels
+    void recolorBlocks(std::string& data, const BlockMask& mask, const size_t& firstBlock, const BlockLayout& layout, const bool& fixBC1Indices, const Exchange& exchange);
+}
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <typeinfo>
+#include <span>
 #include <sstream>
 
 #include <utility/path.hpp>
+#include <utility/buffer.hpp>
 
 class FileType {    
     //static_assert(std::is_enum_v<error_enum>, "error_enum must be an enum type");
@@ -21,10 +23,10 @@ protected:
 
 class RawFile final : public FileType {
 public:
-    std::stringstream data;
+    Utility::ByteStream data;
 
     RawFile() = default;
-    explicit RawFile(const std::string& data_) :
+    explicit RawFile(std::span<const char> data_) :
         data(data_)
     {}
 private:
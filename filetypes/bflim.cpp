@@ -393,7 +393,7 @@ namespace FileTypes {
         return loadFromBinary(file);
     }
     
-    FLIMError FLIMFile::exportAsDDS(const fspath& outPath) {
+    FLIMError FLIMFile::exportAsDDS(const fspath& outPath, Utility::WorkStealingPool* pool) {
         uint32_t format;
         std::string format_;
         std::array<uint8_t, 4> compSel{};
@@ -567,7 +567,7 @@ namespace FileTypes {
                 break;
         }
 
-        std::string result = swizzleSurf(info.width, info.height, 1, static_cast<GX2SurfaceFormat>(format), GX2_AA_MODE1X, GX2_SURFACE_USE_TEXTURE, surfOut.tileMode, info.swizzle, surfOut.pitch, surfOut.bpp, 0, 0, this->data, false);
+        std::string result = swizzleSurf(info.width, info.height, 1, static_cast<GX2SurfaceFormat>(format), GX2_AA_MODE1X, GX2_SURFACE_USE_TEXTURE, surfOut.tileMode, info.swizzle, surfOut.pitch, surfOut.bpp, 0, 0, this->data, false, pool);
         uint32_t size;
 
         if(BCn_formats.contains(format)) {
@@ -590,7 +590,7 @@ namespace FileTypes {
         return FLIMError::NONE;
     }
 
-    FLIMError FLIMFile::replaceWithDDS(const fspath& filename, GX2TileMode tileMode, uint8_t swizzle_, bool SRGB) {
+    FLIMError FLIMFile::replaceWithDDS(const fspath& filename, GX2TileMode tileMode, uint8_t swizzle_, bool SRGB, Utility::WorkStealingPool* pool) {
         FileTypes::DDSFile dds;
         if(DDSError err = dds.loadFromFile(filename, SRGB); err != DDSError::NONE) {
             LOG_ERR_AND_RETURN(FLIMError::BAD_DDS);
@@ -607,7 +607,7 @@ namespace FileTypes {
         dds.data.resize(dds.size);
     
         if(dds.format_ == 0xB) {
-            dds.data = rgba4_to_argb4(dds.data);
+            rgba4_to_argb4(dds.data);
         }
 
         if(tileMode == 0) {
@@ -634,7 +634,7 @@ namespace FileTypes {
         uint32_t s = swizzle_ << 8;
         if (tileMode != 1 && tileMode != 2 && tileMode != 3 && tileMode != 16) s |= 0xd0000;
 
-        this->data = swizzleSurf(dds.header.width, dds.header.height, 1, static_cast<GX2SurfaceFormat>(dds.format_), GX2_AA_MODE1X, GX2_SURFACE_USE_TEXTURE, surfOut.tileMode, s, surfOut.pitch, surfOut.bpp, 0, 0, dds.data, true);
+        this->data = swizzleSurf(dds.header.width, dds.header.height, 1, static_cast<GX2SurfaceFormat>(dds.format_), GX2_AA_MODE1X, GX2_SURFACE_USE_TEXTURE, surfOut.tileMode, s, surfOut.pitch, surfOut.bpp, 0, 0, dds.data, true, pool);
 
         if (dds.format_ == 1) {
             if (dds.compSel[3] == 0) dds.format_ = 1;
@@ -698,7 +698,7 @@ namespace FileTypes {
             if (dds.compSel != temp) {
                 temp = {0, 1, 2, 5};
                 if (dds.compSel == temp) {
-                    this->data = swapRB_16bpp(this->data, "rgb565");
+                    swapRB(this->data, SwapRBFormat::RGB565);
                 }
                 else {
                     LOG_TO_DEBUG("Warning: colors may break!");
@@ -710,7 +710,7 @@ namespace FileTypes {
             if (dds.compSel != temp) {
                 temp = {2, 1, 0, 5};
                 if (dds.compSel == temp) {
-                    this->data = swapRB_32bpp(this->data, "rgba8");
+                    swapRB(this->data, SwapRBFormat::RGBA8);
                 }
                 else {
                     LOG_TO_DEBUG("Warning: colors may break!");
@@ -722,7 +722,7 @@ namespace FileTypes {
             if (dds.compSel != temp) {
             temp = {2, 1, 0, 3};
                 if (dds.compSel == temp) {
-                    this->data = swapRB_16bpp(this->data, "rgb5a1");
+                    swapRB(this->data, SwapRBFormat::RGB5A1);
                 }
                 else {
                     LOG_TO_DEBUG("Warning: colors may break!");
@@ -734,7 +734,7 @@ namespace FileTypes {
             if (dds.compSel != temp) {
                 temp = {0, 1, 2, 3};
                 if (dds.compSel == temp) {
-                    this->data = swapRB_16bpp(this->data, "argb4");
+                    swapRB(this->data, SwapRBFormat::ARGB4);
                 }
                 else {
                     LOG_TO_DEBUG("Warning: colors may break!");
@@ -747,10 +747,10 @@ namespace FileTypes {
                 temp = {2, 1, 0, 3};
                 if (dds.compSel == temp) {
                     if (dds.format_ == 0x18) {
-                        this->data = swapRB_32bpp(this->data, "bgr10a2");
+                        swapRB(this->data, SwapRBFormat::BGR10A2);
                     }
                     else {
-                        this->data = swapRB_32bpp(this->data, "rgba8");
+                        swapRB(this->data, SwapRBFormat::RGBA8);
                     }
                 }
                 else {
@@ -8,6 +8,9 @@
 #include <filetypes/shared/gx2.hpp>
 #include <filetypes/baseFiletype.hpp>
 
+namespace Utility {
+    class WorkStealingPool;
+}
 
 
 enum struct [[nodiscard]] FLIMError {
@@ -64,8 +67,8 @@ namespace FileTypes {
 		static FLIMFile createNew();
 		FLIMError loadFromBinary(std::istream& bflim);
 		FLIMError loadFromFile(const fspath& filePath);
-		FLIMError exportAsDDS(const fspath& outPath);
-		FLIMError replaceWithDDS(const fspath& filename, GX2TileMode tileMode, uint8_t swizzle_, bool SRGB);
+		FLIMError exportAsDDS(const fspath& outPath, Utility::WorkStealingPool* pool = nullptr);
+		FLIMError replaceWithDDS(const fspath& filename, GX2TileMode tileMode, uint8_t swizzle_, bool SRGB, Utility::WorkStealingPool* pool = nullptr); //pool is used to swizzle parts of the image at once
 		FLIMError writeToStream(std::ostream& out);
 		FLIMError writeToFile(const fspath& outFilePath);
 	private:
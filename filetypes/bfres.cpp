@@ -352,12 +352,11 @@ namespace FileTypes {
         return FRESError::NONE;
     }
 
-    FRESError resFile::replaceEmbeddedFile(const unsigned int fileIndex, std::stringstream& newFile) {
+    FRESError resFile::replaceEmbeddedFile(const unsigned int fileIndex, std::span<const char> newFile) {
         const uint32_t originalLen = fresHeader.embeddedFiles[fileIndex].fileLength;
 
-        const std::string& inData = newFile.str();
-        fresHeader.embeddedFiles[fileIndex].fileLength = inData.size();
-        const int64_t sizeDiff = inData.size() - originalLen;
+        fresHeader.embeddedFiles[fileIndex].fileLength = newFile.size();
+        const int64_t sizeDiff = newFile.size() - originalLen;
 
         //TODO: change the way the file list/embedded file list is handled so it doesn't completely suck
         if (fileIndex != fresHeader.embeddedFiles.size() - 1) { //Check if it is the last embedded file
@@ -367,7 +366,7 @@ namespace FileTypes {
             }
         }
 
-        fileData.replace(fresHeader.embeddedFiles[fileIndex].dataOffset + fresHeader.embeddedFiles[fileIndex].location - 0x6C, originalLen, inData); //Offset is relative to the location it's stored in the file, location is relative to file start so we take away the header size
+        fileData.replace(fresHeader.embeddedFiles[fileIndex].dataOffset + fresHeader.embeddedFiles[fileIndex].location - 0x6C, originalLen, newFile.data(), newFile.size()); //Offset is relative to the location it's stored in the file, location is relative to file start so we take away the header size
         return FRESError::NONE;
     }
 
@@ -431,7 +430,7 @@ namespace FileTypes {
         return FRESError::NONE;
     }
 
-    FRESError resFile::replaceEmbeddedFile(const std::string& fileName, std::stringstream& newData) {
+    FRESError resFile::replaceEmbeddedFile(const std::string& fileName, std::span<const char> newData) {
         GroupHeader group;
         group.groupLength = *reinterpret_cast<int32_t*>(&fileData[0x20 + (11 * 0x4) + fresHeader.groupOffsets[11] - 0x6C]);
         group.entryCount = *reinterpret_cast<int32_t*>(&fileData[0x20 + (11 * 0x4) + fresHeader.groupOffsets[11] - 0x6C] + 4);
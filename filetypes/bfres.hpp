@@ -6,6 +6,7 @@
 
 #include <string>
 #include <vector>
+#include <span>
 #include <filetypes/subfiles/bftex.hpp>
 #include <filetypes/baseFiletype.hpp>
 
@@ -107,14 +108,14 @@ namespace FileTypes
         FRESError loadFromBinary(std::istream& bfres); // Only does embedded files and textures for now
         FRESError loadFromFile(const fspath& filePath);
         FRESError replaceEmbeddedFile(const std::string& fileName, const fspath& newFilename);
-        FRESError replaceEmbeddedFile(const std::string& fileName, std::stringstream& newData);
+        FRESError replaceEmbeddedFile(const std::string& fileName, std::span<const char> newData);
         FRESError replaceFromDir(const fspath& dirPath);
         FRESError extractToDir(const fspath& dirPath) const; //Only does embedded files for now
         FRESError writeToStream(std::ostream& out);
         FRESError writeToFile(const fspath& outFilePath);
     private:
         FRESError replaceEmbeddedFile(const unsigned int fileIndex, std::istream& newFile);
-        FRESError replaceEmbeddedFile(const unsigned int fileIndex, std::stringstream& newFile);
+        FRESError replaceEmbeddedFile(const unsigned int fileIndex, std::span<const char> newFile);
         void initNew() override {} //Needs a more complete implementation to work
     };
 }
@@ -360,7 +360,7 @@ namespace FileTypes {
 		}
 
         if((format_ == 0x1A || format_ == 0x41A) && bpp == 3) {
-            data = rgb8torgbx8(data);//convert
+            rgb8torgbx8(data);//convert
             bpp += 1;
             size = header.width * header.height * bpp;
         }
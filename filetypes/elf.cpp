@@ -55,6 +55,8 @@ namespace FileTypes {
         ehdr.e_shstrndx = 0x1e;
 
         shdr_table = {};
+        addressIndex = {};
+        pendingRelocations = {};
     }
 
     ELF ELF::createNew() {
@@ -188,6 +190,7 @@ namespace FileTypes {
             shdr_table.emplace_back(i, shdr);
         }
 
+        buildAddressIndex();
         isEmpty = false;
 
         return ELFError::NONE;
@@ -201,6 +204,27 @@ namespace FileTypes {
         return loadFromBinary(file);
     }
 
+    void ELF::buildAddressIndex() {
+        //sizes are read from the section headers on lookup, sections can be extended after this
+        addressIndex.clear();
+        for (const auto& [index, shdr] : shdr_table) {
+            if (shdr.sh_addr == 0 || shdr.data.empty()) continue; //only sections that can be written through an address
+            addressIndex.emplace_back(shdr.sh_addr, index);
+        }
+        std::ranges::sort(addressIndex);
+    }
+
+    offset_t ELF::findAddress(const uint32_t& address) const {
+        //last section that starts at or before the address
+        auto it = std::ranges::upper_bound(addressIndex, address, {}, &std::pair<uint32_t, uint16_t>::first);
+        if (it == addressIndex.begin()) return {0, 0};
+        it--;
+
+        const Elf32_Shdr& shdr = shdr_table[it->second].second;
+        if (address - shdr.sh_addr >= shdr.sh_size) return {0, 0};
+        return {it->second, address - shdr.sh_addr};
+    }
+
     ELFError ELF::extend_section(uint16_t index, const std::string& newData) { //newData is data to append, not replace
         if (isEmpty == true) {
             LOG_ERR_AND_RETURN(ELFError::HEADER_DATA_NOT_LOADED);
@@ -210,6 +234,7 @@ namespace FileTypes {
         if (shdr_table[index].second.data.empty()) { //Can't append data to an empty section
             LOG_ERR_AND_RETURN(ELFError::SECTION_DATA_NOT_LOADED);
         }
+        if (const ELFError err = finalize_section(index); err != ELFError::NONE) return err; //keep queued relocations before the new data
 
         shdr_table[index].second.sh_size += newData.size();
         shdr_table[index].second.data.append(newData);
@@ -225,6 +250,8 @@ namespace FileTypes {
         if (shdr_table[index].second.data.empty()) { //Wouldn't append data to a section that didn't already have some
             LOG_ERR_AND_RETURN(ELFError::SECTION_DATA_NOT_LOADED);
         }
+        if (const ELFError err = finalize_section(index); err != ELFError::NONE) return err;
+
         const uint32_t sectionOffset = startAddr - shdr_table[index].second.sh_addr;
         const uint32_t sizeToData = sectionOffset - shdr_table[index].second.sh_size;
         shdr_table[index].second.sh_size += sizeToData + newData.size();
@@ -233,10 +260,75 @@ namespace FileTypes {
         return ELFError::NONE;
     }
 
+    ELFError ELF::reserve_section(uint16_t index, size_t size) {
+        if (isEmpty == true) {
+            LOG_ERR_AND_RETURN(ELFError::HEADER_DATA_NOT_LOADED);
+        }
+        if (index >= shdr_table.size()) {
+            LOG_ERR_AND_RETURN(ELFError::INDEX_OUT_OF_RANGE);
+        }
+
+        shdr_table[index].second.data.reserve(size);
+        return ELFError::NONE;
+    }
+
+    ELFError ELF::add_relocation(uint16_t index, const Elf32_Rela& reloc) {
+        if (isEmpty == true) {
+            LOG_ERR_AND_RETURN(ELFError::HEADER_DATA_NOT_LOADED);
+        }
+        if (index >= shdr_table.size()) {
+            LOG_ERR_AND_RETURN(ELFError::INDEX_OUT_OF_RANGE);
+        }
+        if (shdr_table[index].second.data.empty()) { //Can't append data to an empty section
+            LOG_ERR_AND_RETURN(ELFError::SECTION_DATA_NOT_LOADED);
+        }
+
+        pendingRelocations[index].push_back(reloc);
+        return ELFError::NONE;
+    }
+
+    ELFError ELF::finalize_section(uint16_t index) {
+        const auto it = pendingRelocations.find(index);
+        if (it == pendingRelocations.end()) return ELFError::NONE;
+
+        const std::vector<Elf32_Rela>& relocations = it->second;
+        std::string& data = shdr_table[index].second.data;
+
+        //swap everything into one block and append it at once
+        size_t offset = data.size();
+        data.resize(data.size() + relocations.size() * 0xC);
+        for (const Elf32_Rela& reloc : relocations) {
+            const uint32_t offset_BE = Utility::Endian::toPlatform(eType::Big, reloc.r_offset);
+            const uint32_t info_BE = Utility::Endian::toPlatform(eType::Big, reloc.r_info);
+            const int32_t addend_BE = Utility::Endian::toPlatform(eType::Big, reloc.r_addend);
+
+            std::memcpy(&data[offset], &offset_BE, 4);
+            std::memcpy(&data[offset + 4], &info_BE, 4);
+            std::memcpy(&data[offset + 8], &addend_BE, 4);
+            offset += 0xC;
+        }
+
+        shdr_table[index].second.sh_size = data.size();
+        pendingRelocations.erase(it);
+        return ELFError::NONE;
+    }
+
+    ELFError ELF::finalize_sections() {
+        if (isEmpty == true) {
+            LOG_ERR_AND_RETURN(ELFError::HEADER_DATA_NOT_LOADED);
+        }
+
+        while (!pendingRelocations.empty()) {
+            if (const ELFError err = finalize_section(pendingRelocations.begin()->first); err != ELFError::NONE) return err;
+        }
+        return ELFError::NONE;
+    }
+
     ELFError ELF::writeToStream(std::ostream& out) {
         if (isEmpty == true) {
             LOG_ERR_AND_RETURN(ELFError::HEADER_DATA_NOT_LOADED);
         }
+        if (const ELFError err = finalize_sections(); err != ELFError::NONE) return err;
         ehdr.e_shnum = shdr_table.size();
         Utility::Endian::toPlatform_inplace(eType::Big, ehdr.e_type);
         Utility::Endian::toPlatform_inplace(eType::Big, ehdr.e_machine);
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <map>
 #include <vector>
 #include <string>
 
@@ -40,11 +41,20 @@ namespace FileTypes {
         ELFError loadFromFile(const fspath& filePath);
         ELFError extend_section(uint16_t index, const std::string& newData);
         ELFError extend_section(uint16_t index, uint32_t startAddr, const std::string& newData);
+        ELFError reserve_section(uint16_t index, size_t size); //reserve space for a section to grow into, size is the total size
+        ELFError add_relocation(uint16_t index, const Elf32_Rela& reloc); //queued and appended to the section with any others when it is finalized
+        ELFError finalize_sections(); //append queued relocations to their sections, done automatically before the section is used or written
         ELFError writeToStream(std::ostream& out);
         ELFError writeToFile(const fspath& outFilePath);
+        offset_t findAddress(const uint32_t& address) const; //section index and offset of a loaded address, {0, 0} if no section has it
     private:
         bool isEmpty = true;
+        std::vector<std::pair<uint32_t, uint16_t>> addressIndex; //start address and index of each loaded section with an address, sorted by address
+        std::map<uint16_t, std::vector<Elf32_Rela>> pendingRelocations; //relocations by section index, kept in native byte order until they're appended
+
         void initNew() override;
+        void buildAddressIndex();
+        ELFError finalize_section(uint16_t index);
     };
 
 }
@@ -4,8 +4,12 @@
 #include <algorithm>
 #include <numeric>
 #include <filesystem>
+#include <iterator>
+#include <tuple>
+#include <unordered_map>
 
 #include <utility/endian.hpp>
+#include <utility/buffer.hpp>
 #include <utility/common.hpp>
 #include <utility/file.hpp>
 #include <command/Log.hpp>
@@ -32,12 +36,13 @@ namespace {
         return hash;
     }
     
-    uint32_t getAlignment(const std::string& fileExt, const FileTypes::SARCFile::File& file) {
+    uint32_t getAlignment(const std::string& fileExt, std::span<const char> data) {
         if (alignments.contains(fileExt)) {
             return alignments.at(fileExt);
         }
-        if (fileExt == "bflim" && file.data.substr(file.data.size() - 0x28, 4) == "FLIM") {
-            uint16_t alignment = *reinterpret_cast<const uint16_t*>(&file.data[(file.data.size() - 8)]);
+        if (fileExt == "bflim" && data.size() >= 0x28 && std::strncmp(&data[data.size() - 0x28], "FLIM", 4) == 0) {
+            uint16_t alignment;
+            std::memcpy(&alignment, &data[data.size() - 8], sizeof(alignment));
             Utility::Endian::toPlatform_inplace(eType::Big, alignment);
             return alignment;
         }
@@ -96,8 +101,8 @@ namespace FileTypes{
         nameTable.padding_0x00[1] = 0x00;
         nameTable.filenames = {};
 
-        file_index_by_name = {};
         files = {};
+        source = {};
     }
 
     SARCFile SARCFile::createNew() {
@@ -125,7 +130,23 @@ namespace FileTypes{
         guessed_alignment = gcd;
     }
 
+    std::span<const char> SARCFile::getData(const File& file) const {
+        if (file.loaded) {
+            return file.data;
+        }
+        return std::span(source).subspan(file.sourceOffset, file.sourceSize);
+    }
+
     SARCError SARCFile::loadFromBinary(std::istream& sarc) {
+        std::vector<char> buffer{std::istreambuf_iterator<char>(sarc), std::istreambuf_iterator<char>()};
+        return loadFromBinary(std::move(buffer));
+    }
+
+    SARCError SARCFile::loadFromBinary(std::vector<char>&& buffer) {
+        //parse the tables through a stream over the buffer, then keep it around for the file data
+        Utility::ByteStream sarc;
+        sarc.assign(std::move(buffer));
+
         if (!sarc.read(header.magicSARC, 4)) LOG_ERR_AND_RETURN(SARCError::REACHED_EOF);
         if (!sarc.read(reinterpret_cast<char*>(&header.headerSize_0x14), sizeof(header.headerSize_0x14))) LOG_ERR_AND_RETURN(SARCError::REACHED_EOF);
         if (!sarc.read(reinterpret_cast<char*>(&header.byteOrderMarker), sizeof(header.byteOrderMarker))) LOG_ERR_AND_RETURN(SARCError::REACHED_EOF);
@@ -183,9 +204,8 @@ namespace FileTypes{
         if (nameTable.headerSize_0x8 != 0x8) LOG_ERR_AND_RETURN(SARCError::UNEXPECTED_VALUE);
         if (nameTable.padding_0x00[0] != 0x00 || nameTable.padding_0x00[1] != 0x00) LOG_ERR_AND_RETURN(SARCError::UNEXPECTED_VALUE);
 
-        std::string fileData(header.fileSize - header.dataOffset, '\0');
-        sarc.seekg(header.dataOffset, std::ios::beg);
-        if (!sarc.read(&fileData[0], header.fileSize - header.dataOffset)) LOG_ERR_AND_RETURN(SARCError::REACHED_EOF);
+        if (header.dataOffset > header.fileSize || header.fileSize > sarc.size()) LOG_ERR_AND_RETURN(SARCError::REACHED_EOF);
+        const uint32_t dataSize = header.fileSize - header.dataOffset;
 
         for (const SFATNode& node : fileTable.nodes) {
             if ((node.attributes & 0xFF000000) >> 24 != 0x01) LOG_ERR_AND_RETURN(SARCError::BAD_NODE_ATTR);
@@ -195,12 +215,19 @@ namespace FileTypes{
 
             const uint32_t hash = calculateHash(name, fileTable.hashKey_0x65);
             if (hash != node.nameHash) LOG_ERR_AND_RETURN(SARCError::FILENAME_HASH_MISMATCH);
+            if (&node != &fileTable.nodes.front() && (&node - 1)->nameHash > hash) LOG_ERR_AND_RETURN(SARCError::UNEXPECTED_VALUE); //lookups rely on the nodes being sorted
+
+            if (node.dataStart > node.dataEnd) LOG_ERR_AND_RETURN(SARCError::UNEXPECTED_VALUE);
+            if (node.dataEnd > dataSize) LOG_ERR_AND_RETURN(SARCError::REACHED_EOF);
 
+            //don't copy the data yet, most files in an archive are never touched
             File& fileEntry = files.emplace_back();
-            file_index_by_name[name] = files.size() - 1;
             fileEntry.name = name;
-            fileEntry.data = fileData.substr(node.dataStart, node.dataEnd - node.dataStart);
+            fileEntry.sourceOffset = header.dataOffset + node.dataStart;
+            fileEntry.sourceSize = node.dataEnd - node.dataStart;
+            fileEntry.loaded = false;
         }
+        source = sarc.take();
 
         guessDefaultAlignment();
         return SARCError::NONE;
@@ -214,11 +241,42 @@ namespace FileTypes{
         return loadFromBinary(file);
     }
 
+    std::optional<size_t> SARCFile::findFile(const std::string& filename) const {
+        //nodes are sorted by name hash, search them instead of keeping a separate map of names
+        const uint32_t hash = calculateHash(filename, fileTable.hashKey_0x65);
+        auto it = std::ranges::lower_bound(fileTable.nodes, hash, {}, &SFATNode::nameHash);
+        for (; it != fileTable.nodes.end() && it->nameHash == hash; it++) { //names can share a hash
+            const size_t index = it - fileTable.nodes.begin();
+            if (files[index].name == filename) {
+                return index;
+            }
+        }
+
+        return std::nullopt;
+    }
+
     SARCFile::File* SARCFile::getFile(const std::string& filename) {
-        if (!file_index_by_name.contains(filename)) {
+        const std::optional<size_t> index = findFile(filename);
+        if (!index.has_value()) {
             return nullptr;
         }
-        return &files[file_index_by_name.at(filename)];
+
+        //the caller can modify the data, so it needs its own copy
+        File& file = files[index.value()];
+        if (!file.loaded) {
+            const std::span<const char> data = getData(file);
+            file.data.assign(data.data(), data.size());
+            file.loaded = true;
+        }
+        return &file;
+    }
+
+    std::optional<std::span<const char>> SARCFile::viewFile(const std::string& filename) const {
+        const std::optional<size_t> index = findFile(filename);
+        if (!index.has_value()) {
+            return std::nullopt;
+        }
+        return getData(files[index.value()]);
     }
 
     SARCError SARCFile::writeToStream(std::ostream& out) {
@@ -230,7 +288,8 @@ namespace FileTypes{
             
             std::string filetype = entry.name.substr(entry.name.find('.') + 1);
             filetype.pop_back();
-            const uint32_t alignment = std::max(guessed_alignment, getAlignment(filetype, entry));
+            const std::span<const char> data = getData(entry);
+            const uint32_t alignment = std::max(guessed_alignment, getAlignment(filetype, data));
             if (alignment != 0) {
                 unsigned int padLen = alignment - (curDataOffset % alignment);
                 if (padLen == alignment) padLen = 0;
@@ -240,7 +299,7 @@ namespace FileTypes{
                 node.dataStart = curDataOffset;
             }
 
-            node.dataEnd = node.dataStart + entry.data.size();
+            node.dataEnd = node.dataStart + data.size();
             curDataOffset = node.dataEnd;
         }
 
@@ -295,10 +354,12 @@ namespace FileTypes{
             }
         }
 
+        //files that were never loaded are copied straight from the original archive
         for (unsigned int i = 0; i < files.size(); i++) {
             const std::string fill((header.dataOffset + fileTable.nodes[i].dataStart) - out.tellp(), '\0');
             out.write(&fill[0], fill.size());
-            out.write(&files[i].data[0], files[i].data.size());
+            const std::span<const char> data = getData(files[i]);
+            out.write(data.data(), data.size());
         }
 
         header.fileSize = out.tellp();
@@ -327,26 +388,29 @@ namespace FileTypes{
             {
                 LOG_ERR_AND_RETURN(SARCError::COULD_NOT_OPEN);
             }
-            outFile.write(&file.data[0], file.data.size());
+            const std::span<const char> data = getData(file);
+            outFile.write(data.data(), data.size());
         }
         return SARCError::NONE;
     }
 
-    SARCError SARCFile::replaceFile(const std::string& filename, const std::stringstream& newData) {
-        if(!file_index_by_name.contains(filename)) LOG_ERR_AND_RETURN(SARCError::STRING_NOT_FOUND);
-        const size_t& fileIndex = file_index_by_name.at(filename);
-        File& entry = files[fileIndex];
+    SARCError SARCFile::replaceFile(const std::string& filename, std::span<const char> newData) {
+        const std::optional<size_t> fileIndex = findFile(filename);
+        if(!fileIndex.has_value()) LOG_ERR_AND_RETURN(SARCError::STRING_NOT_FOUND);
+        File& entry = files[fileIndex.value()];
 
-        entry.data = newData.str();
+        entry.data.assign(newData.data(), newData.size());
+        entry.loaded = true;
 
         return SARCError::NONE;
     }
 
     SARCError SARCFile::replaceFile(const std::string& filename, const fspath& newFilePath) {
-        const size_t& fileIndex = file_index_by_name.at(filename);
+        const std::optional<size_t> found = findFile(filename);
+        if(!found.has_value()) LOG_ERR_AND_RETURN(SARCError::STRING_NOT_FOUND);
+        const size_t fileIndex = found.value();
         uint32_t curDataOffset = 0;
         {
-            if(!file_index_by_name.contains(filename)) LOG_ERR_AND_RETURN(SARCError::STRING_NOT_FOUND);
             SFATNode& node = fileTable.nodes[fileIndex];
             File& entry = files[fileIndex];
 
@@ -354,6 +418,7 @@ namespace FileTypes{
             curDataOffset = node.dataStart;
 
             entry.data.resize(fileSize);
+            entry.loaded = true;
             std::ifstream inFile(newFilePath, std::ios::binary);
             if (!inFile.read(&entry.data[0], fileSize)) {
                 LOG_ERR_AND_RETURN(SARCError::REACHED_EOF);
@@ -370,7 +435,8 @@ namespace FileTypes{
             
             std::string filetype = entry.name.substr(entry.name.find('.') + 1);
             filetype.pop_back();
-            const uint32_t alignment = std::max(guessed_alignment, getAlignment(filetype, entry));
+            const std::span<const char> data = getData(entry);
+            const uint32_t alignment = std::max(guessed_alignment, getAlignment(filetype, data));
             if (alignment != 0) {
                 unsigned int padLen = alignment - (curDataOffset % alignment);
                 if (padLen == alignment) padLen = 0;
@@ -380,7 +446,7 @@ namespace FileTypes{
                 node.dataStart = curDataOffset;
             }
 
-            node.dataEnd = node.dataStart + entry.data.size();
+            node.dataEnd = node.dataStart + data.size();
             curDataOffset = node.dataEnd;
         }
 
@@ -400,6 +466,7 @@ namespace FileTypes{
             File& entry = files[i];
             entry.name = filename;
             entry.data.resize(fileSize);
+            entry.loaded = true;
 
             std::ifstream inFile(absPath, std::ios::binary);
             if (!inFile.read(&entry.data[0], fileSize)) {
@@ -409,7 +476,7 @@ namespace FileTypes{
             //silly alignment stuff
             std::string filetype = filename.substr(filename.find('.') + 1);
             filetype.pop_back();
-            uint32_t alignment = std::max(guessed_alignment, getAlignment(filetype, entry));
+            uint32_t alignment = std::max(guessed_alignment, getAlignment(filetype, entry.data));
             if (alignment != 0) {
                 unsigned int padLen = alignment - (curDataOffset % alignment);
                 if (padLen == alignment) padLen = 0;
@@ -421,8 +488,6 @@ namespace FileTypes{
 
             node.dataEnd = node.dataStart + entry.data.size();
             curDataOffset = node.dataEnd;
-
-            file_index_by_name[filename] = i;
         }
 
         return SARCError::NONE;
@@ -436,6 +501,7 @@ namespace FileTypes{
 
         uint32_t curDataOffset = 0x14 + 0xC + 0x8; //header sizes
         uint32_t curNameOffset = 0;
+        std::vector<std::pair<uint32_t, File>> found; //name hash, file
         for (const auto& path : std::filesystem::recursive_directory_iterator(dirPath)) {
             if (path.is_regular_file()) {
                 const fspath& absPath = path.path();
@@ -443,10 +509,7 @@ namespace FileTypes{
                 filename += '\0'; //add null terminator
 
                 uint32_t fileSize = std::filesystem::file_size(absPath);
-                SFATNode& node = fileTable.nodes.emplace_back();
-                node.nameHash = calculateHash(filename, fileTable.hashKey_0x65);
-
-                File& entry = files.emplace_back();
+                auto& [hash, entry] = found.emplace_back(calculateHash(filename, fileTable.hashKey_0x65), File{});
                 entry.name = filename;
                 entry.data.resize(fileSize);
 
@@ -466,21 +529,24 @@ namespace FileTypes{
 
         header.dataOffset = curDataOffset;
 
-        std::ranges::sort(files, [&](const File& a, const File& b) {return calculateHash(a.name, fileTable.hashKey_0x65) < calculateHash(b.name, fileTable.hashKey_0x65); });
-        std::ranges::sort(fileTable.nodes, [&](const SFATNode& a, const SFATNode& b) {return a.nameHash < b.nameHash; });
-        fileTable.numFiles = files.size();
+        //nodes have to be sorted by hash for lookups, sort once and build the tables from that order
+        std::ranges::sort(found, [](const auto& a, const auto& b) { return std::tie(a.first, a.second.name) < std::tie(b.first, b.second.name); });
+        fileTable.numFiles = found.size();
+        fileTable.nodes.reserve(found.size());
+        files.reserve(found.size());
 
         curDataOffset = 0;
 
-        for (unsigned int i = 0; i < files.size(); i++) {
-            const File& entry = files[i];
-            SFATNode& node = fileTable.nodes[i];
+        for (auto& [hash, file] : found) {
+            const File& entry = files.emplace_back(std::move(file));
+            SFATNode& node = fileTable.nodes.emplace_back();
+            node.nameHash = hash;
 
             //silly alignment stuff
             const std::string& filename = entry.name;
             std::string filetype = filename.substr(filename.find('.') + 1);
             filetype.pop_back();
-            uint32_t alignment = std::max(guessed_alignment, getAlignment(filetype, entry));
+            uint32_t alignment = std::max(guessed_alignment, getAlignment(filetype, entry.data));
             if (alignment != 0) {
                 unsigned int padLen = alignment - (curDataOffset % alignment);
                 if (padLen == alignment) padLen = 0;
@@ -499,7 +565,6 @@ namespace FileTypes{
             if (numPaddingBytes == 4) numPaddingBytes = 0;
             curNameOffset += numPaddingBytes;
             nameTable.filenames.push_back(filename);
-            file_index_by_name[filename] = i;
         }
 
         header.fileSize = header.dataOffset + fileTable.nodes.back().dataEnd;
@@ -5,8 +5,9 @@
 
 #include <cstdint>
 #include <vector>
-#include <unordered_map>
 #include <string>
+#include <span>
+#include <optional>
 #include <filetypes/baseFiletype.hpp>
 
 
@@ -67,18 +68,25 @@ namespace FileTypes {
     public:
         struct File {
             std::string name;
-            std::string data;
+            std::string data; //only filled once the file is accessed through getFile/replaceFile
+
+            //where the original data is in the loaded archive, used until the file is loaded
+            size_t sourceOffset = 0;
+            uint32_t sourceSize = 0;
+            bool loaded = true;
         };
 
         SARCFile() = default;
         static SARCFile createNew();
         SARCError loadFromBinary(std::istream& sarc);
+        SARCError loadFromBinary(std::vector<char>&& sarc); //keeps the buffer, files are read from it when needed
         SARCError loadFromFile(const fspath& filePath);
-        File* getFile(const std::string& filename);
+        File* getFile(const std::string& filename); //loads the file so its data can be modified
+        std::optional<std::span<const char>> viewFile(const std::string& filename) const; //read-only, doesn't load the file
         SARCError writeToStream(std::ostream& out);
         SARCError writeToFile(const fspath& outFilePath);
         SARCError extractToDir(const fspath& dirPath) const;
-        SARCError replaceFile(const std::string& filename, const std::stringstream& newData);
+        SARCError replaceFile(const std::string& filename, std::span<const char> newData);
         SARCError replaceFile(const std::string& filename, const fspath& newFilePath);
         SARCError rebuildFromDir(const fspath& dirPath);
         SARCError buildFromDir(const fspath& dirPath); //partly untested, should work though
@@ -86,11 +94,13 @@ namespace FileTypes {
         SARCHeader header;
         SFAT fileTable;
         SFNT nameTable;
-        std::unordered_map<std::string, size_t> file_index_by_name;
         std::vector<File> files; //store as vector to keep insertion order
+        std::vector<char> source; //the loaded archive, unloaded files point into it
         uint32_t guessed_alignment;
 
         void initNew() override;
         void guessDefaultAlignment();
+        std::optional<size_t> findFile(const std::string& filename) const;
+        std::span<const char> getData(const File& file) const;
     };
 }
@@ -9,6 +9,7 @@
 #include <filetypes/texture/addrlib.hpp>
 #include <command/Log.hpp>
 #include <filetypes/dds.hpp>
+#include <utility/work_pool.hpp>
 
 using eType = Utility::Endian::Type;
 
@@ -276,7 +277,7 @@ namespace FileTypes::Subfiles {
         return FTEXError::NONE;
     }
 
-    FTEXError FTEXFile::replaceImageData(const fspath& filePath, const GX2TileMode& tileMode, const uint32_t& swizzle_, const bool& SRGB, const bool& importMips) {
+    FTEXError FTEXFile::replaceImageData(const fspath& filePath, const GX2TileMode& tileMode, const uint32_t& swizzle_, const bool& SRGB, const bool& importMips, Utility::WorkStealingPool* pool) {
         FileTypes::DDSFile dds;
         if(DDSError err = dds.loadFromFile(filePath, SRGB); err != DDSError::NONE) {
             LOG_ERR_AND_RETURN(FTEXError::BAD_DDS);
@@ -323,10 +324,18 @@ namespace FileTypes::Subfiles {
             blkHeight = 1;
         }
 
+        //lay out every level first, they can be swizzled independently after that
+        struct MipLevel {
+            std::string data;
+            uint32_t width;
+            uint32_t height;
+            size_t alignBytes;
+        };
+
         uint32_t mipSize = 0;
         std::vector<uint32_t> mipOffsets_ = {};
 
-        std::vector<std::string> result;
+        std::vector<MipLevel> levels;
         uint32_t mipLevel = 0;
         for(; mipLevel < dds.header.numMips; mipLevel++) {
             auto offset_size = getCurrentMipOffset_Size(width, height, blkWidth, blkHeight, bpp, mipLevel);
@@ -346,20 +355,31 @@ namespace FileTypes::Subfiles {
             }
 
             data_ += std::string(surfInfo.surfSize - offset_size.second, '\0');
-            std::string dataAlignBytes(roundUp(mipSize, surfInfo.baseAlign) - mipSize, '\0');
+            const size_t alignBytes = roundUp(mipSize, surfInfo.baseAlign) - mipSize;
 
             if(mipLevel) {
-                mipSize += surfInfo.surfSize + dataAlignBytes.size();
+                mipSize += surfInfo.surfSize + alignBytes;
             }
 
             if(mipSize > mipData.size()) {
-                mipSize -= surfInfo.surfSize + dataAlignBytes.size();
+                mipSize -= surfInfo.surfSize + alignBytes;
                 mipLevel -= 1;
                 break;
             }
 
-            result.push_back(dataAlignBytes + swizzleSurf(width_, height_, 1, static_cast<GX2SurfaceFormat>(dds.format_), aaMode, use, surfInfo.tileMode, s, surfInfo.pitch, surfInfo.bpp, 0, 0, data_, true));
+            levels.push_back({std::move(data_), width_, height_, alignBytes});
+        }
+
+        std::vector<std::string> result(levels.size());
+        std::vector<Utility::WorkStealingPool::Task_t> tasks;
+        tasks.reserve(levels.size());
+        for(size_t i = 0; i < levels.size(); i++) {
+            tasks.emplace_back([&, i]() {
+                const MipLevel& level = levels[i];
+                result[i] = std::string(level.alignBytes, '\0') + swizzleSurf(level.width, level.height, 1, static_cast<GX2SurfaceFormat>(dds.format_), aaMode, use, surfInfo.tileMode, s, surfInfo.pitch, surfInfo.bpp, 0, 0, level.data, true, pool);
+            });
         }
+        Utility::runTasks(tasks, pool);
         
         dimension = GX2_SURFACE_DIM_TEXTURE_2D;
         width = dds.header.width;
@@ -11,6 +11,10 @@
 #include <filetypes/shared/gx2.hpp>
 #include <filetypes/shared/bfres_structs.hpp>
 
+namespace Utility {
+    class WorkStealingPool;
+}
+
 enum struct [[nodiscard]] FTEXError {
     NONE = 0,
     REACHED_EOF,
@@ -75,7 +79,7 @@ namespace FileTypes::Subfiles {
         FTEXFile() = default;
         static FTEXFile createNew();
         FTEXError loadFromBinary(std::istream& ftex);
-        FTEXError replaceImageData(const fspath& filePath, const GX2TileMode& tileMode, const uint32_t& swizzle_, const bool& SRGB, const bool& importMips);
+        FTEXError replaceImageData(const fspath& filePath, const GX2TileMode& tileMode, const uint32_t& swizzle_, const bool& SRGB, const bool& importMips, Utility::WorkStealingPool* pool = nullptr); //mip levels are swizzled on the pool if there is one
         FTEXError writeToStream(std::ostream& out);
     private:
         void initNew();
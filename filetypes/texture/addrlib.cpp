@@ -1,8 +1,18 @@
 #include "addrlib.hpp"
 
+#include <bit>
 #include <array>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <algorithm>
 #include <unordered_set>
 
+#include <utility/work_pool.hpp>
+
 
 static const std::unordered_set BCn_formats = {
     GX2_SURFACE_FORMAT_UNORM_BC1, GX2_SURFACE_FORMAT_SRGB_BC1, GX2_SURFACE_FORMAT_UNORM_BC2, GX2_SURFACE_FORMAT_SRGB_BC2,
@@ -225,6 +235,20 @@ uint32_t computeSurfaceBankSwappedWidth(GX2TileMode tileMode, uint32_t bpp, uint
     return bankSwapWidth;
 }
 
+static void getMacroTileDims(GX2TileMode tileMode, uint32_t& macroTilePitch, uint32_t& macroTileHeight) {
+    macroTilePitch = 32;
+    macroTileHeight = 16;
+
+    if(tileMode == GX2TileMode::GX2_TILE_MODE_TILED_2B_THIN2 || tileMode == GX2TileMode::GX2_TILE_MODE_TILED_2D_THIN2) {
+        macroTilePitch = 16;
+        macroTileHeight = 32;
+    }
+    else if(tileMode == GX2TileMode::GX2_TILE_MODE_TILED_2B_THIN4 || tileMode == GX2TileMode::GX2_TILE_MODE_TILED_2D_THIN4) {
+        macroTilePitch = 8;
+        macroTileHeight = 64;
+    }
+}
+
 uint64_t computeSurfaceAddrFromCoordLinear(uint32_t x, uint32_t y, uint32_t slice, uint32_t sample, uint32_t bpp, uint32_t pitch, uint32_t height, uint32_t numSlices) {
     uint64_t sliceOffset = pitch * height * (slice + sample * numSlices);
     return (y * pitch + x + sliceOffset) * bpp;
@@ -313,17 +337,8 @@ uint64_t computeSurfaceAddrFromCoordMacroTiled(uint32_t x, uint32_t y, uint32_t
     uint64_t sliceBytes = (height * pitch * microTileThickness * bpp * numSamples + 7) / 8;
     uint64_t sliceOffset = sliceBytes * ((sampleSlice + numSampleSplits * slice) / microTileThickness);
 
-    uint64_t macroTilePitch = 32;
-    uint64_t macroTileHeight = 16;
-
-    if(tileMode == GX2TileMode::GX2_TILE_MODE_TILED_2B_THIN2 || tileMode == GX2TileMode::GX2_TILE_MODE_TILED_2D_THIN2) {
-        macroTilePitch = 16;
-        macroTileHeight = 32;
-    }
-    else if(tileMode == GX2TileMode::GX2_TILE_MODE_TILED_2B_THIN4 || tileMode == GX2TileMode::GX2_TILE_MODE_TILED_2D_THIN4) {
-        macroTilePitch = 8;
-        macroTileHeight = 64;
-    }
+    uint32_t macroTilePitch, macroTileHeight;
+    getMacroTileDims(tileMode, macroTilePitch, macroTileHeight);
 
     uint64_t macroTilesPerRow = pitch / macroTilePitch;
     uint64_t macroTileBytes = (numSamples * microTileThickness * bpp * macroTileHeight * macroTilePitch + 7) / 8;
@@ -341,7 +356,88 @@ uint64_t computeSurfaceAddrFromCoordMacroTiled(uint32_t x, uint32_t y, uint32_t
     return (bank << 9) | (pipe << 8) | (totalOffset & 255) | ((totalOffset & -256) << 3);
 }
 
-std::string swizzleSurf(uint32_t width, uint32_t height, uint32_t depth, GX2SurfaceFormat format_, GX2AAMode aa, GX2SurfaceUse use, GX2TileMode tileMode, uint32_t swizzle_, uint32_t pitch, uint32_t bitsPerPixel, uint32_t slice, uint32_t sample, const std::string& data, bool swizzle) {
+// Tiled addresses split into a pattern that repeats every few pixels and a base offset for each micro/macro tile
+// The pattern only depends on these, so it's built once and shared between textures
+namespace {
+    struct SwizzlePattern {
+        uint32_t periodWidth = 0;
+        uint32_t periodHeight = 0;
+        uint32_t tileWidth = 0;
+        uint32_t tileHeight = 0;
+        std::vector<uint32_t> offsets; // tiled offset of each pixel in the period, before the tile's base is added
+        std::vector<uint8_t> runs; // pixels from this one that stay contiguous in the tiled data, without leaving the tile
+    };
+
+    using PatternKey = std::tuple<GX2TileMode, uint32_t, bool, uint32_t, uint32_t, uint32_t>; // tile mode, bpp, depth, pipe swizzle, bank swizzle, slice
+
+    std::mutex patternMut;
+    std::map<PatternKey, std::shared_ptr<const SwizzlePattern>> patternCache;
+
+    std::shared_ptr<const SwizzlePattern> buildPattern(GX2TileMode tileMode, uint32_t bpp, bool isDepth, uint32_t pipeSwizzle, uint32_t bankSwizzle, uint32_t slice) {
+        std::shared_ptr<SwizzlePattern> pattern = std::make_shared<SwizzlePattern>();
+        const bool macroTiled = tileMode >= GX2_TILE_MODE_TILED_2D_THIN1;
+
+        if(macroTiled) {
+            // pipe and bank come from x bits 3-4 and y bits 3-5
+            pattern->periodWidth = 32;
+            pattern->periodHeight = 64;
+            getMacroTileDims(tileMode, pattern->tileWidth, pattern->tileHeight);
+        }
+        else {
+            pattern->periodWidth = 8;
+            pattern->periodHeight = 8;
+            pattern->tileWidth = 8;
+            pattern->tileHeight = 8;
+        }
+
+        const uint64_t sliceIn = isThickMacroTiled(tileMode) ? slice >> 2 : slice;
+        const uint64_t bankPipeSwizzle = pipeSwizzle + 2 * bankSwizzle + sliceIn * computeSurfaceRotationFromTileMode(tileMode);
+
+        pattern->offsets.resize(pattern->periodWidth * pattern->periodHeight);
+        for(uint32_t y = 0; y < pattern->periodHeight; y++) {
+            for(uint32_t x = 0; x < pattern->periodWidth; x++) {
+                const uint64_t elemOffset = (bpp * computePixelIndexWithinMicroTile(x, y, slice, bpp, tileMode, isDepth)) / 8;
+
+                uint64_t offset = elemOffset;
+                if(macroTiled) {
+                    const uint64_t bankPipe = ((computePipeFromCoordWoRotation(x, y) + 2 * computeBankFromCoordWoRotation(x, y)) ^ bankPipeSwizzle) % 8;
+                    offset = (bankPipe << 8) | (elemOffset & 255) | ((elemOffset & -256) << 3);
+                }
+                pattern->offsets[y * pattern->periodWidth + x] = offset;
+            }
+        }
+
+        pattern->runs.resize(pattern->offsets.size());
+        for(uint32_t y = 0; y < pattern->periodHeight; y++) {
+            for(uint32_t x = pattern->periodWidth; x-- > 0;) {
+                const uint32_t index = y * pattern->periodWidth + x;
+                pattern->runs[index] = 1;
+                if((x + 1) % pattern->tileWidth == 0) continue;
+
+                // bank swapping flips bits 9-10 per tile, a run can't cross a change there
+                const uint32_t offset = pattern->offsets[index], next = pattern->offsets[index + 1];
+                if(next == offset + bpp / 8 && ((next ^ offset) & 0x700) == 0) {
+                    pattern->runs[index] = pattern->runs[index + 1] + 1;
+                }
+            }
+        }
+
+        return pattern;
+    }
+
+    std::shared_ptr<const SwizzlePattern> getPattern(GX2TileMode tileMode, uint32_t bpp, bool isDepth, uint32_t pipeSwizzle, uint32_t bankSwizzle, uint32_t slice) {
+        const PatternKey key{tileMode, bpp, isDepth, pipeSwizzle, bankSwizzle, slice};
+
+        std::scoped_lock lock(patternMut);
+        std::shared_ptr<const SwizzlePattern>& pattern = patternCache[key];
+        if(!pattern) {
+            pattern = buildPattern(tileMode, bpp, isDepth, pipeSwizzle, bankSwizzle, slice);
+        }
+        return pattern;
+    }
+}
+
+std::string swizzleSurf(uint32_t width, uint32_t height, uint32_t depth, GX2SurfaceFormat format_, GX2AAMode aa, GX2SurfaceUse use, GX2TileMode tileMode, uint32_t swizzle_, uint32_t pitch, uint32_t bitsPerPixel, uint32_t slice, uint32_t sample, const std::string& data, bool swizzle, Utility::WorkStealingPool* pool) {
     uint32_t bytesPerPixel = bitsPerPixel / 8;
 
     std::string result(data.size(), '\0');
@@ -353,34 +449,114 @@ std::string swizzleSurf(uint32_t width, uint32_t height, uint32_t depth, GX2Surf
 
     uint32_t pipeSwizzle = (swizzle_ >> 8) & 1;
     uint32_t bankSwizzle = (swizzle_ >> 9) & 3;
+    const bool isDepth = static_cast<bool>(use & 4);
+    const uint32_t numSamples = 1 << aa;
 
     tileMode = GX2TileModeToAddrTileMode(tileMode);
 
-    uint64_t pos;
-    for(uint32_t y = 0; y < height; y++) {
-        for(uint32_t x = 0; x < width; x++) {
-            if(tileMode == GX2_TILE_MODE_DEFAULT || tileMode == GX2_TILE_MODE_LINEAR_ALIGNED) {
-                pos = computeSurfaceAddrFromCoordLinear(x, y, slice, sample, bytesPerPixel, pitch, height, depth);
-            }
-            else if(tileMode == GX2_TILE_MODE_TILED_1D_THIN1 || tileMode == GX2_TILE_MODE_TILED_1D_THICK) {
-                pos = computeSurfaceAddrFromCoordMicroTiled(x, y, slice, bitsPerPixel, pitch, height, tileMode, static_cast<bool>(use & 4));
-            }
-            else {
-                pos = computeSurfaceAddrFromCoordMacroTiled(x, y, slice, sample, bitsPerPixel, pitch, height, 1 << aa, tileMode, static_cast<bool>(use & 4), pipeSwizzle, bankSwizzle);
-            }
+    // copies count pixels that are contiguous in both layouts, pixels that would go past the end of the data are skipped
+    const auto copyRun = [&](uint64_t pos, uint64_t pos_, uint64_t count) {
+        const uint64_t last = std::max(pos, pos_);
+        if(last >= data.size()) return;
+        count = std::min(count, (data.size() - last) / bytesPerPixel);
+
+        if(swizzle == false) {
+            std::memcpy(&result[pos_], &data[pos], count * bytesPerPixel);
+        }
+        else {
+            std::memcpy(&result[pos], &data[pos_], count * bytesPerPixel);
+        }
+    };
+
+    // every pixel is written once, so bands of rows never touch the same bytes
+    // bands are a multiple of every tile height
+    static constexpr uint32_t BAND_HEIGHT = 64;
+    const auto forEachBand = [&](const auto& swizzleRows) {
+        if(pool == nullptr || height <= BAND_HEIGHT) {
+            swizzleRows(0, height);
+            return;
+        }
 
-            uint32_t pos_ = (y * width + x) * bytesPerPixel;
+        std::vector<Utility::WorkStealingPool::Task_t> tasks;
+        for(uint32_t start = 0; start < height; start += BAND_HEIGHT) {
+            tasks.emplace_back([&swizzleRows, start, end = std::min(start + BAND_HEIGHT, height)]() { swizzleRows(start, end); });
+        }
+        Utility::runTasks(tasks, pool);
+    };
 
-            if((pos_ + bytesPerPixel <= data.size()) && (pos + bytesPerPixel <= data.size())) {
-                if(swizzle == false) {
-                    result.replace(pos_, bytesPerPixel, data.substr(pos, bytesPerPixel));
+    if(bitsPerPixel < 8 || bitsPerPixel % 8 != 0) {
+        return result;
+    }
+
+    if(tileMode == GX2_TILE_MODE_DEFAULT || tileMode == GX2_TILE_MODE_LINEAR_ALIGNED) {
+        forEachBand([&](uint32_t start, uint32_t end) {
+            for(uint32_t y = start; y < end; y++) {
+                copyRun(computeSurfaceAddrFromCoordLinear(0, y, slice, sample, bytesPerPixel, pitch, height, depth), static_cast<uint64_t>(y) * width * bytesPerPixel, width);
+            }
+        });
+        return result;
+    }
+
+    const bool macroTiled = tileMode >= GX2_TILE_MODE_TILED_2D_THIN1;
+    const uint32_t thickness = computeSurfaceThickness(tileMode);
+    const uint64_t microTileBytes = (64 * thickness * bitsPerPixel + 7) / 8;
+    const uint64_t sliceBytes = (static_cast<uint64_t>(pitch) * height * thickness * bitsPerPixel + 7) / 8;
+    const uint64_t sliceOffset = sliceBytes * (slice / thickness);
+
+    uint32_t macroTilePitch = 0, macroTileHeight = 0, bankSwapWidth = 0;
+    uint64_t macroTileBytes = 0;
+    if(macroTiled) {
+        getMacroTileDims(tileMode, macroTilePitch, macroTileHeight);
+        macroTileBytes = (thickness * bitsPerPixel * macroTileHeight * macroTilePitch + 7) / 8;
+        if(isBankSwappedTileMode(tileMode)) {
+            bankSwapWidth = computeSurfaceBankSwappedWidth(tileMode, bitsPerPixel, numSamples, pitch);
+        }
+    }
+
+    // the pattern only covers single sample surfaces, and macro tiles have to line up with micro tiles so the base doesn't carry into the pattern
+    const bool usePattern = !macroTiled || (numSamples == 1 && sample == 0 && std::has_single_bit(microTileBytes) && macroTileBytes % (8 * microTileBytes) == 0 && sliceOffset % (8 * microTileBytes) == 0);
+    if(!usePattern) {
+        forEachBand([&](uint32_t start, uint32_t end) {
+            for(uint32_t y = start; y < end; y++) {
+                for(uint32_t x = 0; x < width; x++) {
+                    const uint64_t pos = computeSurfaceAddrFromCoordMacroTiled(x, y, slice, sample, bitsPerPixel, pitch, height, numSamples, tileMode, isDepth, pipeSwizzle, bankSwizzle);
+                    copyRun(pos, (static_cast<uint64_t>(y) * width + x) * bytesPerPixel, 1);
+                }
+            }
+        });
+        return result;
+    }
+
+    const std::shared_ptr<const SwizzlePattern> pattern = getPattern(tileMode, bitsPerPixel, isDepth, pipeSwizzle, bankSwizzle, slice);
+    forEachBand([&](uint32_t start, uint32_t end) {
+        for(uint32_t y = start; y < end; y++) {
+            const uint32_t tileY = y / pattern->tileHeight;
+            const uint32_t* offsets = &pattern->offsets[(y % pattern->periodHeight) * pattern->periodWidth];
+            const uint8_t* runs = &pattern->runs[(y % pattern->periodHeight) * pattern->periodWidth];
+
+            for(uint32_t x = 0; x < width;) {
+                const uint32_t tileX = x / pattern->tileWidth;
+                const uint32_t periodX = x % pattern->periodWidth;
+
+                uint64_t pos;
+                if(macroTiled) {
+                    const uint64_t base = ((tileX + static_cast<uint64_t>(pitch / macroTilePitch) * tileY) * macroTileBytes + sliceOffset) >> 3;
+                    uint64_t bankSwap = 0;
+                    if(bankSwapWidth != 0) {
+                        bankSwap = bankSwapOrder[(macroTilePitch * tileX / bankSwapWidth) & 3];
+                    }
+                    pos = (offsets[periodX] ^ (bankSwap << 9)) + ((base & 255) | ((base & -256) << 3));
                 }
                 else {
-                    result.replace(pos, bytesPerPixel, data.substr(pos_, bytesPerPixel));
+                    pos = offsets[periodX] + microTileBytes * (tileX + static_cast<uint64_t>(pitch >> 3) * tileY) + sliceOffset;
                 }
+
+                const uint32_t count = std::min<uint32_t>(runs[periodX], width - x);
+                copyRun(pos, (static_cast<uint64_t>(y) * width + x) * bytesPerPixel, count);
+                x += count;
             }
         }
-    }
+    });
 
     return result;
 }
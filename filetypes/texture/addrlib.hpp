@@ -5,6 +5,9 @@
 
 #include <filetypes/shared/gx2.hpp>
 
+namespace Utility {
+    class WorkStealingPool;
+}
 
 
 struct tileInfo {
@@ -85,7 +88,7 @@ uint64_t computeSurfaceAddrFromCoordMicroTiled(uint32_t x, uint32_t y, uint32_t
 
 uint64_t computeSurfaceAddrFromCoordMacroTiled(uint32_t x, uint32_t y, uint32_t slice, uint32_t sample, uint32_t bpp, uint32_t pitch, uint32_t height, uint32_t numSamples, GX2TileMode tileMode, bool isDepth, uint32_t pipeSwizzle, uint32_t bankSwizzle);
 
-std::string swizzleSurf(uint32_t width, uint32_t height, uint32_t depth, GX2SurfaceFormat format_, GX2AAMode aa, GX2SurfaceUse use, GX2TileMode tileMode, uint32_t swizzle_, uint32_t pitch, uint32_t bitsPerPixel, uint32_t slice, uint32_t sample, const std::string& data, bool swizzle);
+std::string swizzleSurf(uint32_t width, uint32_t height, uint32_t depth, GX2SurfaceFormat format_, GX2AAMode aa, GX2SurfaceUse use, GX2TileMode tileMode, uint32_t swizzle_, uint32_t pitch, uint32_t bitsPerPixel, uint32_t slice, uint32_t sample, const std::string& data, bool swizzle, Utility::WorkStealingPool* pool = nullptr); //pool splits the surface into bands of rows, nullptr does it on this thread
 
 uint32_t powTwoAlign(uint32_t x, uint32_t align);
 
@@ -1,143 +1,326 @@
 #include "formconv.hpp"
 
-std::string rgb8torgbx8(const std::string& data) {
-    const size_t numPixels = data.size() / 3;
-    std::string newData(numPixels * 4, '\0');
-
-    for(size_t i = 0; i < numPixels; i++) {
-        newData[4 * i + 0] = data[3 * i + 0];
-        newData[4 * i + 1] = data[3 * i + 1];
-        newData[4 * i + 2] = data[3 * i + 2];
-        newData[4 * i + 3] = '\xFF';
+#include <cstring>
+
+#include <utility/endian.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define FORMCONV_SSE2
+    #include <emmintrin.h>
+    #if defined(__GNUC__)
+        // SSSE3 and AVX2 kernels are compiled for those targets and only used if the CPU has them
+        #define FORMCONV_X86_DISPATCH
+        #include <immintrin.h>
+    #endif
+#elif defined(__ARM_NEON) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    #define FORMCONV_NEON
+    #include <arm_neon.h>
+#endif
+
+using eType = Utility::Endian::Type;
+
+
+
+namespace {
+    // Every swap is out = (pixel & keep) | ((pixel & left) << leftShift) | ((pixel & right) >> rightShift)
+    template<typename T>
+    struct SwapMasks {
+        T keep;
+        T left;
+        uint32_t leftShift;
+        T right;
+        uint32_t rightShift;
+    };
+
+    constexpr SwapMasks<uint16_t> RGB565_MASKS = {0x07E0, 0x001F, 11, 0xF800, 11};
+    constexpr SwapMasks<uint16_t> RGB5A1_MASKS = {0x83E0, 0x001F, 10, 0x7C00, 10};
+    constexpr SwapMasks<uint16_t> RGBA4_MASKS = {0xF0F0, 0x000F, 8, 0x0F00, 8};
+    constexpr SwapMasks<uint16_t> ARGB4_MASKS = {0x0F0F, 0x00F0, 8, 0xF000, 8};
+    constexpr SwapMasks<uint16_t> RGBA4_TO_ARGB4_MASKS = {0x0000, 0x0FFF, 4, 0xF000, 12};
+    constexpr SwapMasks<uint32_t> RGBA8_MASKS = {0xFF00FF00, 0x000000FF, 16, 0x00FF0000, 16};
+    constexpr SwapMasks<uint32_t> BGR10A2_MASKS = {0xC00FFC00, 0x000003FF, 20, 0x3FF00000, 20};
+
+    // Each kernel converts as many whole vectors as it can from the start and returns how many pixels that was
+    template<typename T>
+    using SwapKernel = size_t (*)(uint8_t* data, size_t numPixels, const SwapMasks<T>& masks);
+    // Converts blocks of pixels from the end back to the start, so nothing is overwritten before it's read
+    using ExpandKernel = void (*)(uint8_t* data, size_t numBlocks);
+
+    template<typename T>
+    void swapScalar(uint8_t* data, size_t numPixels, const SwapMasks<T>& masks) {
+        for(size_t i = 0; i < numPixels; i++) {
+            T pixel;
+            std::memcpy(&pixel, data + i * sizeof(T), sizeof(T));
+            pixel = Utility::Endian::toPlatform(eType::Little, pixel);
+
+            pixel = (pixel & masks.keep) | static_cast<T>((pixel & masks.left) << masks.leftShift) | static_cast<T>((pixel & masks.right) >> masks.rightShift);
+
+            pixel = Utility::Endian::toPlatform(eType::Little, pixel);
+            std::memcpy(data + i * sizeof(T), &pixel, sizeof(T));
+        }
     }
 
-    return newData;
-}
-
-uint16_t _swapRB_rgb565(uint16_t pixel) {
-    uint8_t red = pixel & 0x1F;
-    uint8_t green = (pixel & 0x7E0) >> 5;
-    uint8_t blue = (pixel & 0xF800) >> 11;
-
-    return (red << 11) | (green << 5) | blue;
-}
-
-uint16_t _swapRB_rgb5a1(uint16_t pixel) {
-    uint8_t red = pixel & 0x1F;
-    uint8_t green = (pixel & 0x3E0) >> 5;
-    uint8_t blue = (pixel & 0x7c00) >> 10;
-    uint8_t alpha = (pixel & 0x8000) >> 15;
-
-    return (alpha << 15) | (red << 10) | (green << 5) | blue;
-}
-
-uint16_t _swapRB_rgba4(uint16_t pixel) {
-    uint8_t red = pixel & 0xF;
-    uint8_t green = (pixel & 0xF0) >> 4;
-    uint8_t blue = (pixel & 0xF00) >> 8;
-    uint8_t alpha = (pixel & 0xF000) >> 12;
-
-    return (alpha << 12) | (red << 8) | (green << 4) | blue;
-}
-
-uint16_t _swapRB_argb4(uint16_t pixel) {
-    uint8_t alpha = pixel & 0xF;
-    uint8_t red = (pixel & 0xF0) >> 4;
-    uint8_t green = (pixel & 0xF00) >> 8;
-    uint8_t blue = (pixel & 0xF000) >> 12;
-
-    return (red << 12) | (green << 8) | (blue << 4) | alpha;
-}
+    template<typename T>
+    size_t swapNone(uint8_t*, size_t, const SwapMasks<T>&) {
+        return 0;
+    }
 
-std::string swapRB_16bpp(const std::string& data, const std::string& format_) {
-    const size_t numPixels = data.size() / 2;
+    void expandScalar(uint8_t* data, size_t first, size_t last) {
+        for(size_t i = last; i-- > first;) {
+            const uint8_t r = data[3 * i + 0], g = data[3 * i + 1], b = data[3 * i + 2];
+            data[4 * i + 0] = r;
+            data[4 * i + 1] = g;
+            data[4 * i + 2] = b;
+            data[4 * i + 3] = 0xFF;
+        }
+    }
 
-    std::string new_data(numPixels * 2, '\0');
+    #ifdef FORMCONV_SSE2
+        template<typename T>
+        size_t swapSSE2(uint8_t* data, size_t numPixels, const SwapMasks<T>& masks) {
+            constexpr size_t perVector = sizeof(__m128i) / sizeof(T);
+            const __m128i leftShift = _mm_cvtsi32_si128(masks.leftShift);
+            const __m128i rightShift = _mm_cvtsi32_si128(masks.rightShift);
+
+            __m128i keep, left, right;
+            if constexpr (sizeof(T) == 2) {
+                keep = _mm_set1_epi16(static_cast<short>(masks.keep));
+                left = _mm_set1_epi16(static_cast<short>(masks.left));
+                right = _mm_set1_epi16(static_cast<short>(masks.right));
+            }
+            else {
+                keep = _mm_set1_epi32(static_cast<int>(masks.keep));
+                left = _mm_set1_epi32(static_cast<int>(masks.left));
+                right = _mm_set1_epi32(static_cast<int>(masks.right));
+            }
+
+            const size_t count = numPixels - numPixels % perVector;
+            for(size_t i = 0; i < count; i += perVector) {
+                __m128i* ptr = reinterpret_cast<__m128i*>(data + i * sizeof(T));
+                const __m128i pixels = _mm_loadu_si128(ptr);
+
+                __m128i shiftedLeft, shiftedRight;
+                if constexpr (sizeof(T) == 2) {
+                    shiftedLeft = _mm_sll_epi16(_mm_and_si128(pixels, left), leftShift);
+                    shiftedRight = _mm_srl_epi16(_mm_and_si128(pixels, right), rightShift);
+                }
+                else {
+                    shiftedLeft = _mm_sll_epi32(_mm_and_si128(pixels, left), leftShift);
+                    shiftedRight = _mm_srl_epi32(_mm_and_si128(pixels, right), rightShift);
+                }
+
+                _mm_storeu_si128(ptr, _mm_or_si128(_mm_and_si128(pixels, keep), _mm_or_si128(shiftedLeft, shiftedRight)));
+            }
+
+            return count;
+        }
+    #endif
+
+    #ifdef FORMCONV_X86_DISPATCH
+        template<typename T>
+        __attribute__((target("avx2"))) size_t swapAVX2(uint8_t* data, size_t numPixels, const SwapMasks<T>& masks) {
+            constexpr size_t perVector = sizeof(__m256i) / sizeof(T);
+            const __m128i leftShift = _mm_cvtsi32_si128(masks.leftShift);
+            const __m128i rightShift = _mm_cvtsi32_si128(masks.rightShift);
+
+            __m256i keep, left, right;
+            if constexpr (sizeof(T) == 2) {
+                keep = _mm256_set1_epi16(static_cast<short>(masks.keep));
+                left = _mm256_set1_epi16(static_cast<short>(masks.left));
+                right = _mm256_set1_epi16(static_cast<short>(masks.right));
+            }
+            else {
+                keep = _mm256_set1_epi32(static_cast<int>(masks.keep));
+                left = _mm256_set1_epi32(static_cast<int>(masks.left));
+                right = _mm256_set1_epi32(static_cast<int>(masks.right));
+            }
+
+            const size_t count = numPixels - numPixels % perVector;
+            for(size_t i = 0; i < count; i += perVector) {
+                __m256i* ptr = reinterpret_cast<__m256i*>(data + i * sizeof(T));
+                const __m256i pixels = _mm256_loadu_si256(ptr);
+
+                __m256i shiftedLeft, shiftedRight;
+                if constexpr (sizeof(T) == 2) {
+                    shiftedLeft = _mm256_sll_epi16(_mm256_and_si256(pixels, left), leftShift);
+                    shiftedRight = _mm256_srl_epi16(_mm256_and_si256(pixels, right), rightShift);
+                }
+                else {
+                    shiftedLeft = _mm256_sll_epi32(_mm256_and_si256(pixels, left), leftShift);
+                    shiftedRight = _mm256_srl_epi32(_mm256_and_si256(pixels, right), rightShift);
+                }
+
+                _mm256_storeu_si256(ptr, _mm256_or_si256(_mm256_and_si256(pixels, keep), _mm256_or_si256(shiftedLeft, shiftedRight)));
+            }
+
+            return count;
+        }
 
-    for (size_t i = 0; i < numPixels; i++) {
-        uint16_t pixel = (data[2 * i + 1] << 8) | data[2 * i + 0];
+        // 4 pixels per block, the last 4 bytes of the load belong to the next block and are dropped by the shuffle
+        __attribute__((target("ssse3"))) void expandSSSE3(uint8_t* data, size_t numBlocks) {
+            const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
 
-        uint16_t new_pixel;
-        if (format_ == "rgb565") {
-            new_pixel = _swapRB_rgb565(pixel);
+            for(size_t block = numBlocks; block-- > 0;) {
+                const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + block * 12));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(data + block * 16), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+            }
         }
-        else if (format_ == "rgb5a1") {
-            new_pixel = _swapRB_rgb5a1(pixel);
+
+        // 8 pixels per block, each half is loaded separately since the shuffle can't cross 128-bit lanes
+        __attribute__((target("avx2"))) void expandAVX2(uint8_t* data, size_t numBlocks) {
+            const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+            for(size_t block = numBlocks; block-- > 0;) {
+                const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + block * 24));
+                const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + block * 24 + 12));
+                const __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + block * 32), _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alpha));
+            }
         }
-        else if (format_ == "rgba4") {
-            new_pixel = _swapRB_rgba4(pixel);
+    #endif
+
+    #ifdef FORMCONV_NEON
+        size_t swapNEON16(uint8_t* data, size_t numPixels, const SwapMasks<uint16_t>& masks) {
+            const uint16x8_t keep = vdupq_n_u16(masks.keep);
+            const uint16x8_t left = vdupq_n_u16(masks.left);
+            const uint16x8_t right = vdupq_n_u16(masks.right);
+            const int16x8_t leftShift = vdupq_n_s16(static_cast<int16_t>(masks.leftShift));
+            const int16x8_t rightShift = vdupq_n_s16(-static_cast<int16_t>(masks.rightShift)); // negative shifts go right
+
+            const size_t count = numPixels - numPixels % 8;
+            for(size_t i = 0; i < count; i += 8) {
+                uint16_t* ptr = reinterpret_cast<uint16_t*>(data + i * 2);
+                const uint16x8_t pixels = vld1q_u16(ptr);
+                const uint16x8_t shifted = vorrq_u16(vshlq_u16(vandq_u16(pixels, left), leftShift), vshlq_u16(vandq_u16(pixels, right), rightShift));
+                vst1q_u16(ptr, vorrq_u16(vandq_u16(pixels, keep), shifted));
+            }
+
+            return count;
         }
-        else {
-            new_pixel = _swapRB_argb4(pixel);
+
+        size_t swapNEON32(uint8_t* data, size_t numPixels, const SwapMasks<uint32_t>& masks) {
+            const uint32x4_t keep = vdupq_n_u32(masks.keep);
+            const uint32x4_t left = vdupq_n_u32(masks.left);
+            const uint32x4_t right = vdupq_n_u32(masks.right);
+            const int32x4_t leftShift = vdupq_n_s32(static_cast<int32_t>(masks.leftShift));
+            const int32x4_t rightShift = vdupq_n_s32(-static_cast<int32_t>(masks.rightShift));
+
+            const size_t count = numPixels - numPixels % 4;
+            for(size_t i = 0; i < count; i += 4) {
+                uint32_t* ptr = reinterpret_cast<uint32_t*>(data + i * 4);
+                const uint32x4_t pixels = vld1q_u32(ptr);
+                const uint32x4_t shifted = vorrq_u32(vshlq_u32(vandq_u32(pixels, left), leftShift), vshlq_u32(vandq_u32(pixels, right), rightShift));
+                vst1q_u32(ptr, vorrq_u32(vandq_u32(pixels, keep), shifted));
+            }
+
+            return count;
         }
 
-        new_data[2 * i + 1] = (new_pixel & 0xFF00) >> 8;
-        new_data[2 * i + 0] = new_pixel & 0xFF;
+        // 16 pixels per block, deinterleaving the channels does the whole shuffle
+        void expandNEON(uint8_t* data, size_t numBlocks) {
+            for(size_t block = numBlocks; block-- > 0;) {
+                const uint8x16x3_t rgb = vld3q_u8(data + block * 48);
+                const uint8x16x4_t rgbx = {{rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(0xFF)}};
+                vst4q_u8(data + block * 64, rgbx);
+            }
+        }
+    #endif
+
+    struct Kernels {
+        SwapKernel<uint16_t> swap16 = &swapNone<uint16_t>;
+        SwapKernel<uint32_t> swap32 = &swapNone<uint32_t>;
+        ExpandKernel expand = nullptr;
+        size_t expandBlock = 0; // pixels per expand block
+    };
+
+    Kernels selectKernels() {
+        Kernels kernels;
+
+        #ifdef FORMCONV_SSE2
+            kernels.swap16 = &swapSSE2<uint16_t>;
+            kernels.swap32 = &swapSSE2<uint32_t>;
+        #endif
+
+        #ifdef FORMCONV_X86_DISPATCH
+            __builtin_cpu_init();
+            if(__builtin_cpu_supports("ssse3")) {
+                kernels.expand = &expandSSSE3;
+                kernels.expandBlock = 4;
+            }
+            if(__builtin_cpu_supports("avx2")) {
+                kernels.swap16 = &swapAVX2<uint16_t>;
+                kernels.swap32 = &swapAVX2<uint32_t>;
+                kernels.expand = &expandAVX2;
+                kernels.expandBlock = 8;
+            }
+        #endif
+
+        #ifdef FORMCONV_NEON
+            kernels.swap16 = &swapNEON16;
+            kernels.swap32 = &swapNEON32;
+            kernels.expand = &expandNEON;
+            kernels.expandBlock = 16;
+        #endif
+
+        return kernels;
     }
 
-    return new_data;
-}
-
-std::string rgba4_to_argb4(const std::string& data) {
-    const size_t numPixels = data.size() / 2;
-
-    std::string new_data;
-    new_data.resize(numPixels * 2);
-
-    for (size_t i = 0; i < numPixels; i++) {
-        uint16_t pixel = ((data[2 * i + 1] << 8) | data[2 * i + 0]);
-
-        uint16_t rgb = (pixel & 0xFFF);
-        uint16_t alpha = (pixel & 0xF000) >> 12;
-
-        uint16_t new_pixel = (rgb << 4) | alpha;
-
-        new_data[2 * i + 1] = (new_pixel & 0xFF00) >> 8;
-        new_data[2 * i + 0] = new_pixel & 0xFF;
+    const Kernels& getKernels() {
+        static const Kernels kernels = selectKernels();
+        return kernels;
     }
 
-    return new_data;
-}
-
-uint32_t _swapRB_bgr10a2(uint32_t pixel) {
-    uint8_t red = (pixel & 0x3FF00000) >> 20;
-    uint8_t green = (pixel & 0xFFC00) >> 10;
-    uint8_t blue = pixel & 0x3FF;
-    uint8_t alpha = (pixel & 0xC0000000) >> 30;
+    template<typename T>
+    void swap(std::string& data, const SwapMasks<T>& masks, SwapKernel<T> kernel) {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(data.data());
+        const size_t numPixels = data.size() / sizeof(T);
 
-    return (alpha << 30) | (blue << 20) | (green << 10) | red;
+        const size_t done = kernel(bytes, numPixels, masks);
+        swapScalar(bytes + done * sizeof(T), numPixels - done, masks);
+    }
 }
 
-uint32_t _swapRB_rgba8(uint32_t pixel) {
-    uint8_t red = pixel & 0xFF;
-    uint8_t green = (pixel & 0xFF00) >> 8;
-    uint8_t blue = (pixel & 0xFF0000) >> 16;
-    uint8_t alpha = (pixel & 0xFF000000) >> 24;
-
-    return (alpha << 24) | (red << 16) | (green << 8) | blue;
+void rgb8torgbx8(std::string& data) {
+    const size_t numPixels = data.size() / 3;
+    data.resize(numPixels * 4);
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(data.data());
+
+    // the end is converted first, the vector loads can read a little past their block
+    const Kernels& kernels = getKernels();
+    const size_t numBlocks = kernels.expand != nullptr ? numPixels / kernels.expandBlock : 0;
+    expandScalar(bytes, numBlocks * kernels.expandBlock, numPixels);
+    if(numBlocks > 0) {
+        kernels.expand(bytes, numBlocks);
+    }
 }
 
-std::string swapRB_32bpp(const std::string& data, const std::string& format_) {
-    const size_t numPixels = data.size() / 4;
-
-    std::string new_data(numPixels * 4, '\0');
-
-    for (size_t i = 0; i < numPixels; i++) {
-        uint32_t pixel = (data[4 * i + 3] << 24) | (data[4 * i + 2] << 16) | (data[4 * i + 1] << 8) | data[4 * i + 0];
-        uint32_t new_pixel;
-
-        if (format_ == "bgr10a2") {
-            new_pixel = _swapRB_bgr10a2(pixel);
-        }
-        else {
-            new_pixel = _swapRB_rgba8(pixel);
-        }
-
-        new_data[4 * i + 3] = (new_pixel & 0xFF000000) >> 24;
-        new_data[4 * i + 2] = (new_pixel & 0xFF0000) >> 16;
-        new_data[4 * i + 1] = (new_pixel & 0xFF00) >> 8;
-        new_data[4 * i + 0] = new_pixel & 0xFF;
+void swapRB(std::string& data, SwapRBFormat format) {
+    const Kernels& kernels = getKernels();
+
+    switch(format) {
+        case SwapRBFormat::RGB565:
+            swap(data, RGB565_MASKS, kernels.swap16);
+            break;
+        case SwapRBFormat::RGB5A1:
+            swap(data, RGB5A1_MASKS, kernels.swap16);
+            break;
+        case SwapRBFormat::RGBA4:
+            swap(data, RGBA4_MASKS, kernels.swap16);
+            break;
+        case SwapRBFormat::ARGB4:
+            swap(data, ARGB4_MASKS, kernels.swap16);
+            break;
+        case SwapRBFormat::RGBA8:
+            swap(data, RGBA8_MASKS, kernels.swap32);
+            break;
+        case SwapRBFormat::BGR10A2:
+            swap(data, BGR10A2_MASKS, kernels.swap32);
+            break;
     }
+}
 
-    return new_data;
+void rgba4_to_argb4(std::string& data) {
+    swap(data, RGBA4_TO_ARGB4_MASKS, getKernels().swap16);
 }
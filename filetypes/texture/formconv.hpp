@@ -3,22 +3,20 @@
 #include <cstdint>
 #include <string>
 
-std::string rgb8torgbx8(const std::string& data);
+// Pixel layouts swapRB can convert, resolved once by the caller instead of compared per pixel
+enum struct SwapRBFormat {
+    RGB565 = 0,
+    RGB5A1,
+    RGBA4,
+    ARGB4,
+    RGBA8,
+    BGR10A2,
+};
 
-uint16_t _swapRB_rgb565(uint16_t pixel);
+// These all convert the data in place, the swaps leave a trailing partial pixel as is
 
-uint16_t _swapRB_rgb5a1(uint16_t pixel);
+void rgb8torgbx8(std::string& data); //grows the string to fit the alpha channel, alpha is set to 0xFF and a trailing partial pixel is dropped
 
-uint16_t _swapRB_rgba4(uint16_t pixel);
+void swapRB(std::string& data, SwapRBFormat format);
 
-uint16_t _swapRB_argb4(uint16_t pixel);
-
-std::string swapRB_16bpp(const std::string& data, const std::string& format_);
-
-std::string rgba4_to_argb4(const std::string& data);
-
-uint32_t _swapRB_bgr10a2(uint32_t pixel);
-
-uint32_t _swapRB_rgba8(uint32_t pixel);
-
-std::string swapRB_32bpp(const std::string& data, const std::string& format_);
+void rgba4_to_argb4(std::string& data);
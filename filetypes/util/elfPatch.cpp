@@ -0,0 +1,164 @@
+#include "elfPatch.hpp"
+
+#include <cstring>
+#include <span>
+#include <string_view>
+
+#include <filetypes/util/elfUtil.hpp>
+#include <utility/endian.hpp>
+#include <utility/file.hpp>
+#include <command/Log.hpp>
+
+using eType = Utility::Endian::Type;
+
+namespace {
+    static constexpr char DIFF_MAGIC[4] = {'W', 'W', 'P', 'D'};
+    static constexpr char SYMBOLS_MAGIC[4] = {'W', 'W', 'S', 'Y'};
+    static constexpr uint16_t VERSION = 1;
+
+    class BlobReader {
+    public:
+        explicit BlobReader(std::string_view data_) : data(data_) {}
+
+        template<typename T>
+        bool read(T& out) {
+            if(data.size() - pos < sizeof(T)) return false;
+            std::memcpy(&out, data.data() + pos, sizeof(T));
+            Utility::Endian::toPlatform_inplace(eType::Big, out);
+            pos += sizeof(T);
+            return true;
+        }
+
+        bool read(std::string& out, const size_t& length) {
+            if(data.size() - pos < length) return false;
+            out.assign(data.substr(pos, length));
+            pos += length;
+            return true;
+        }
+
+        bool skip(const size_t& length) {
+            if(data.size() - pos < length) return false;
+            pos += length;
+            return true;
+        }
+
+    private:
+        std::string_view data;
+        size_t pos = 0;
+    };
+
+    PatchError readHeader(BlobReader& reader, const char (&magic)[4]) {
+        std::string fileMagic;
+        uint16_t version = 0;
+        if(!reader.read(fileMagic, 4)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+        if(std::memcmp(fileMagic.data(), magic, 4) != 0) LOG_ERR_AND_RETURN(PatchError::NOT_PATCH);
+        if(!reader.read(version)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+        if(version != VERSION) LOG_ERR_AND_RETURN(PatchError::UNKNOWN_VERSION);
+        if(!reader.skip(2)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+
+        return PatchError::NONE;
+    }
+}
+
+namespace elfPatch {
+    const char* PatchErrorGetName(PatchError err) {
+        switch (err) {
+            case PatchError::NONE:
+                return "NONE";
+            case PatchError::COULD_NOT_OPEN:
+                return "COULD_NOT_OPEN";
+            case PatchError::NOT_PATCH:
+                return "NOT_PATCH";
+            case PatchError::UNKNOWN_VERSION:
+                return "UNKNOWN_VERSION";
+            case PatchError::REACHED_EOF:
+                return "REACHED_EOF";
+            default:
+                return "UNKNOWN";
+        }
+    }
+
+    PatchError loadPatch(const fspath& filePath, Patch& out) {
+        std::string fileData;
+        if(Utility::getFileContents(filePath, fileData, true)) LOG_ERR_AND_RETURN(PatchError::COULD_NOT_OPEN);
+
+        BlobReader reader(fileData);
+        if(const PatchError err = readHeader(reader, DIFF_MAGIC); err != PatchError::NONE) return err;
+
+        uint32_t numChunks = 0, numRelocations = 0;
+        if(!reader.read(numChunks)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+        if(!reader.read(numRelocations)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+
+        out.data.resize(numChunks);
+        for(DataChunk& chunk : out.data) {
+            uint32_t length = 0;
+            if(!reader.read(chunk.address)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+            if(!reader.read(length)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+            if(!reader.read(chunk.data, length)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+            if(!reader.skip((4 - length % 4) % 4)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+        }
+
+        out.relocations.resize(numRelocations);
+        for(Relocation& relocation : out.relocations) {
+            if(!reader.read(relocation.sectionIndex)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+            if(!reader.skip(2)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+            if(!reader.read(relocation.rela.r_offset)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+            if(!reader.read(relocation.rela.r_info)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+            if(!reader.read(relocation.rela.r_addend)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+        }
+
+        return PatchError::NONE;
+    }
+
+    PatchError loadSymbols(const fspath& filePath, std::unordered_map<std::string, uint32_t>& out) {
+        std::string fileData;
+        if(Utility::getFileContents(filePath, fileData, true)) LOG_ERR_AND_RETURN(PatchError::COULD_NOT_OPEN);
+
+        BlobReader reader(fileData);
+        if(const PatchError err = readHeader(reader, SYMBOLS_MAGIC); err != PatchError::NONE) return err;
+
+        uint32_t numSymbols = 0;
+        if(!reader.read(numSymbols)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+
+        out.reserve(out.size() + numSymbols);
+        for(uint32_t i = 0; i < numSymbols; i++) {
+            uint32_t address = 0;
+            uint16_t nameLength = 0;
+            std::string name;
+            if(!reader.read(address)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+            if(!reader.read(nameLength)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+            if(!reader.read(name, nameLength)) LOG_ERR_AND_RETURN(PatchError::REACHED_EOF);
+
+            out[std::move(name)] = address;
+        }
+
+        return PatchError::NONE;
+    }
+
+    ELFError applyPatch(FileTypes::ELF& elf, const Patch& patch) {
+        //make room for all the chunks that extend the code section up front
+        if(elf.shdr_table.size() <= 2) LOG_ERR_AND_RETURN(ELFError::INDEX_OUT_OF_RANGE);
+        const Elf32_Shdr& text = elf.shdr_table[2].second;
+        size_t textSize = text.data.size();
+        for(const DataChunk& chunk : patch.data) {
+            if(chunk.address >= text.sh_addr + textSize) textSize = chunk.address - text.sh_addr + chunk.data.size();
+        }
+        if(const ELFError err = elf.reserve_section(2, textSize); err != ELFError::NONE) return err;
+
+        for(const DataChunk& chunk : patch.data) {
+            const offset_t sectionOffset = elfUtil::AddressToOffset(elf, chunk.address);
+            if(!sectionOffset) { //address not in section
+                if(const ELFError err = elf.extend_section(2, chunk.address, chunk.data); err != ELFError::NONE) return err; //add data at the specified offset
+            }
+            else {
+                if(const ELFError err = elfUtil::write_bytes(elf, sectionOffset, std::span<const char>(chunk.data)); err != ELFError::NONE) return err;
+            }
+        }
+
+        for(const Relocation& relocation : patch.relocations) {
+            if(const ELFError err = elf.add_relocation(relocation.sectionIndex, relocation.rela); err != ELFError::NONE) return err;
+        }
+
+        return ELFError::NONE;
+    }
+}
@@ -0,0 +1,49 @@
+//Precompiled ASM patches for the game's ELF
+//asm/compile_diffs.py turns the assembled YAML diffs into these, the format is described there
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <filetypes/elf.hpp>
+#include <utility/path.hpp>
+
+
+
+enum struct [[nodiscard]] PatchError {
+    NONE = 0,
+    COULD_NOT_OPEN,
+    NOT_PATCH,
+    UNKNOWN_VERSION,
+    REACHED_EOF,
+    UNKNOWN,
+    COUNT
+};
+
+namespace elfPatch {
+    struct DataChunk {
+        uint32_t address;
+        std::string data;
+    };
+
+    struct Relocation {
+        uint16_t sectionIndex; //relocation section this entry is added to
+        Elf32_Rela rela;
+    };
+
+    struct Patch {
+        std::vector<DataChunk> data;
+        std::vector<Relocation> relocations;
+    };
+
+    const char* PatchErrorGetName(PatchError err);
+
+    PatchError loadPatch(const fspath& filePath, Patch& out);
+
+    PatchError loadSymbols(const fspath& filePath, std::unordered_map<std::string, uint32_t>& out);
+
+    ELFError applyPatch(FileTypes::ELF& elf, const Patch& patch);
+}
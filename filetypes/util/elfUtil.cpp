@@ -1,5 +1,9 @@
 #include "elfUtil.hpp"
 
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+
 #include <utility/endian.hpp>
 #include <command/Log.hpp>
 
@@ -8,6 +12,11 @@
     if(offset.offset > elf.shdr_table[offset.shdrIdx].second.data.size() - 1) LOG_ERR_AND_RETURN(ELFError::INDEX_OUT_OF_RANGE);    \
 }
 
+#define CHECK_WRITE_RANGE(elf, offset, numBytes) {    \
+    CHECK_OFFSET_RANGES(elf, offset);    \
+    if(numBytes > elf.shdr_table[offset.shdrIdx].second.data.size() - offset.offset) LOG_ERR_AND_RETURN(ELFError::INDEX_OUT_OF_RANGE);    \
+}
+
 using eType = Utility::Endian::Type;
 
 namespace elfUtil {
@@ -19,12 +28,7 @@ namespace elfUtil {
     }
 
     offset_t AddressToOffset(const FileTypes::ELF& elf, const uint32_t& address) { //calculates offset into section, returns first value as section index and second as offset
-        for (const uint16_t index : {2, 3, 4}) { //only check a few sections that might be written to
-            if (containsAddress(address, elf.shdr_table[index].second.sh_addr, elf.shdr_table[index].second.sh_size)) {
-                return {index, address - elf.shdr_table[index].second.sh_addr};
-            }
-        }
-        return {0, 0};
+        return elf.findAddress(address);
     }
 
     offset_t AddressToOffset(const FileTypes::ELF& elf, const uint32_t& address, const uint16_t& sectionIndex) {
@@ -35,18 +39,11 @@ namespace elfUtil {
     }
 
     ELFError addRelocation(FileTypes::ELF& elf, const uint16_t& shdrIdx, const Elf32_Rela& reloc) {
-        uint32_t offset_BE = Utility::Endian::toPlatform(eType::Big, reloc.r_offset);
-        uint32_t info_BE = Utility::Endian::toPlatform(eType::Big, reloc.r_info);
-        int32_t addend_BE = Utility::Endian::toPlatform(eType::Big, reloc.r_addend);
-
-        std::string entry(12, '\0');
-        entry.replace(0, 4, reinterpret_cast<const char*>(&offset_BE), 4);
-        entry.replace(4, 4, reinterpret_cast<const char*>(&info_BE), 4);
-        entry.replace(8, 4, reinterpret_cast<const char*>(&addend_BE), 4);
-        return elf.extend_section(shdrIdx, entry);
+        return elf.add_relocation(shdrIdx, reloc);
     }
 
     ELFError removeRelocation(FileTypes::ELF& elf, const offset_t& offset) {
+        if(const ELFError err = elf.finalize_sections(); err != ELFError::NONE) return err; //offset could be in a relocation that hasn't been appended yet
         CHECK_OFFSET_RANGES(elf, offset);
         elf.shdr_table[offset.shdrIdx].second.data.replace(offset.offset, 0xC, 0xC, '\0');
 
@@ -63,8 +60,8 @@ namespace elfUtil {
     ELFError write_u16(FileTypes::ELF& out, const offset_t& offset, const uint16_t& data) {
         const uint16_t toWrite = Utility::Endian::toPlatform(eType::Big, data);
         
-        CHECK_OFFSET_RANGES(out, offset);
-        out.shdr_table[offset.shdrIdx].second.data.replace(offset.offset, 2, reinterpret_cast<const char*>(&toWrite), 2);
+        CHECK_WRITE_RANGE(out, offset, sizeof(toWrite));
+        std::memcpy(&out.shdr_table[offset.shdrIdx].second.data[offset.offset], &toWrite, sizeof(toWrite));
 
         return ELFError::NONE;
     }
@@ -72,8 +69,8 @@ namespace elfUtil {
     ELFError write_u32(FileTypes::ELF& out, const offset_t& offset, const uint32_t& data) {
         const uint32_t toWrite = Utility::Endian::toPlatform(eType::Big, data);
         
-        CHECK_OFFSET_RANGES(out, offset);
-        out.shdr_table[offset.shdrIdx].second.data.replace(offset.offset, 4, reinterpret_cast<const char*>(&toWrite), 4);
+        CHECK_WRITE_RANGE(out, offset, sizeof(toWrite));
+        std::memcpy(&out.shdr_table[offset.shdrIdx].second.data[offset.offset], &toWrite, sizeof(toWrite));
         
         return ELFError::NONE;
     }
@@ -81,18 +78,20 @@ namespace elfUtil {
     ELFError write_float(FileTypes::ELF& out, const offset_t& offset, const float& data) {
         const uint32_t toWrite = Utility::Endian::toPlatform(eType::Big, std::bit_cast<const uint32_t>(data));
         
-        CHECK_OFFSET_RANGES(out, offset);
-        out.shdr_table[offset.shdrIdx].second.data.replace(offset.offset, 4, reinterpret_cast<const char*>(&toWrite), 4);
+        CHECK_WRITE_RANGE(out, offset, sizeof(toWrite));
+        std::memcpy(&out.shdr_table[offset.shdrIdx].second.data[offset.offset], &toWrite, sizeof(toWrite));
         
         return ELFError::NONE;
     }
 
     ELFError write_bytes(FileTypes::ELF& out, const offset_t& offset, const std::vector<uint8_t>& bytes) {
-        CHECK_OFFSET_RANGES(out, offset);
-        for (unsigned int i = 0; i < bytes.size(); i++) {
-            out.shdr_table[offset.shdrIdx].second.data[offset.offset + i] = reinterpret_cast<const char&>(bytes[i]);
-        }
-        
+        return write_bytes(out, offset, std::span(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+    }
+
+    ELFError write_bytes(FileTypes::ELF& out, const offset_t& offset, std::span<const char> bytes) {
+        CHECK_WRITE_RANGE(out, offset, bytes.size());
+        std::memcpy(&out.shdr_table[offset.shdrIdx].second.data[offset.offset], bytes.data(), bytes.size());
+
         return ELFError::NONE;
     }
 
@@ -122,4 +121,60 @@ namespace elfUtil {
 
         return bytes;
     }
+
+    void WriteBatch::write_u8(const uint32_t& address, const uint8_t& data) {
+        write_bytes(address, std::span(reinterpret_cast<const char*>(&data), sizeof(data)));
+    }
+
+    void WriteBatch::write_u16(const uint32_t& address, const uint16_t& data) {
+        const uint16_t toWrite = Utility::Endian::toPlatform(eType::Big, data);
+        write_bytes(address, std::span(reinterpret_cast<const char*>(&toWrite), sizeof(toWrite)));
+    }
+
+    void WriteBatch::write_u32(const uint32_t& address, const uint32_t& data) {
+        const uint32_t toWrite = Utility::Endian::toPlatform(eType::Big, data);
+        write_bytes(address, std::span(reinterpret_cast<const char*>(&toWrite), sizeof(toWrite)));
+    }
+
+    void WriteBatch::write_float(const uint32_t& address, const float& data) {
+        write_u32(address, std::bit_cast<uint32_t>(data));
+    }
+
+    void WriteBatch::write_bytes(const uint32_t& address, std::span<const char> bytes) {
+        writes.push_back({address, static_cast<uint32_t>(bytes.size()), data.size()});
+        data.append(bytes.data(), bytes.size());
+    }
+
+    ELFError WriteBatch::apply(FileTypes::ELF& out) {
+        std::vector<size_t> order(writes.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::stable_sort(order, {}, [this](const size_t& i) { return writes[i].address; });
+
+        //sorting would change which write wins where they overlap
+        for (size_t i = 1; i < order.size(); i++) {
+            const Write& prev = writes[order[i - 1]];
+            if (writes[order[i]].address - prev.address < prev.size) {
+                std::iota(order.begin(), order.end(), 0);
+                break;
+            }
+        }
+
+        Elf32_Shdr* section = nullptr;
+        for (const size_t& i : order) {
+            const Write& write = writes[i];
+            if (section == nullptr || write.address - section->sh_addr >= section->data.size()) {
+                const offset_t offset = out.findAddress(write.address);
+                if (!offset) LOG_ERR_AND_RETURN(ELFError::INDEX_OUT_OF_RANGE);
+                section = &out.shdr_table[offset.shdrIdx].second;
+            }
+
+            const uint32_t sectionOffset = write.address - section->sh_addr;
+            if (write.size > section->data.size() - sectionOffset) LOG_ERR_AND_RETURN(ELFError::INDEX_OUT_OF_RANGE);
+            std::memcpy(&section->data[sectionOffset], &data[write.dataOffset], write.size);
+        }
+
+        writes.clear();
+        data.clear();
+        return ELFError::NONE;
+    }
 }
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 #include <vector>
+#include <string>
+#include <span>
 
 #include <filetypes/elf.hpp>
 
@@ -26,6 +28,8 @@ namespace elfUtil {
 
     ELFError write_bytes(FileTypes::ELF& out, const offset_t& offset, const std::vector<uint8_t>& Bytes);
 
+    ELFError write_bytes(FileTypes::ELF& out, const offset_t& offset, std::span<const char> bytes);
+
     uint8_t read_u8(const FileTypes::ELF& in, const offset_t& offset);
 
     uint16_t read_u16(const FileTypes::ELF& in, const offset_t& offset);
@@ -35,4 +39,27 @@ namespace elfUtil {
     float read_float(const FileTypes::ELF& in, const offset_t& offset);
 
     std::vector<uint8_t> read_bytes(const FileTypes::ELF& in, const offset_t& offset, const size_t& NumBytes);
+
+    // Collects writes by address and applies them together
+    // Writes are sorted by address so each run of writes into a section only looks the section up once
+    class WriteBatch {
+    public:
+        void write_u8(const uint32_t& address, const uint8_t& data);
+        void write_u16(const uint32_t& address, const uint16_t& data);
+        void write_u32(const uint32_t& address, const uint32_t& data);
+        void write_float(const uint32_t& address, const float& data);
+        void write_bytes(const uint32_t& address, std::span<const char> bytes);
+
+        ELFError apply(FileTypes::ELF& out); //writes everything and clears the batch, writes that overlap are applied in the order they were added
+
+    private:
+        struct Write {
+            uint32_t address;
+            uint32_t size;
+            size_t dataOffset;
+        };
+
+        std::vector<Write> writes;
+        std::string data;
+    };
 }
@@ -3,18 +3,29 @@
 #include <cstring>
 
 #include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
 
 #include <libs/zlib-ng.hpp>
 #include <filetypes/shared/elf_structs.hpp>
 #include <utility/endian.hpp>
 #include <utility/common.hpp>
 #include <utility/file.hpp>
+#include <utility/work_pool.hpp>
 #include <command/Log.hpp>
 
 using eType = Utility::Endian::Type;
 
 
 
+namespace {
+    bool isDeflated(const Elf32_Shdr& section) {
+        return section.sh_flags & static_cast<std::underlying_type_t<SectionFlags>>(SectionFlags::SHF_DEFLATED);
+    }
+}
+
+
 namespace FileTypes {
     const char* RPXErrorGetName(RPXError err) {
         switch (err) {
@@ -35,7 +46,7 @@ namespace FileTypes {
         }
     }
 
-    RPXError rpx_decompress(std::istream& in, std::ostream& out)
+    RPXError rpx_decompress(std::istream& in, std::ostream& out, Utility::WorkStealingPool* pool)
     {
         Elf32_Ehdr header{};
 
@@ -156,46 +167,70 @@ namespace FileTypes {
         std::ranges::sort(sectionHeaders, [](const shdr_index_t& a, const shdr_index_t& b) { return a.second.sh_offset < b.second.sh_offset; });
         Utility::seek(out, header.e_shoff + header.e_shentsize * header.e_shnum);
 
-        for(auto& [index, section] : sectionHeaders) {
+        // read every section first, they're decompressed in parallel and written in offset order afterwards
+        std::vector<std::string> compressed(sectionHeaders.size());
+        std::vector<std::string> sectionData(sectionHeaders.size());
+        std::vector<Utility::WorkStealingPool::Task_t> tasks;
+        std::atomic<bool> zlibFailed = false;
+        for(size_t i = 0; i < sectionHeaders.size(); i++) {
+            const Elf32_Shdr& section = sectionHeaders[i].second;
             if(section.sh_offset == 0) {
                 continue;
             }
 
             in.seekg(section.sh_offset, std::ios::beg);
 
-            section.sh_offset = out.tellp();
-
-            if(section.sh_flags & static_cast<std::underlying_type_t<SectionFlags>>(SectionFlags::SHF_DEFLATED)) {
+            if(isDeflated(section)) {
                 // uncompressed size is stored at the start of each compressed section
                 uint32_t uncompressedSize = 0;
+                if(section.sh_size < sizeof(uncompressedSize)) {
+                    LOG_ERR_AND_RETURN(RPXError::UNEXPECTED_VALUE);
+                }
                 if(!in.read(reinterpret_cast<char*>(&uncompressedSize), sizeof(uncompressedSize))) {
                     LOG_ERR_AND_RETURN(RPXError::REACHED_EOF);
                 }
                 Utility::Endian::toPlatform_inplace(eType::Big, uncompressedSize);
-                std::string outBuf(uncompressedSize, '\0');
-                
-                std::string sectionData(section.sh_size, '\0');
-                if(!in.read(sectionData.data(), sectionData.size() - sizeof(uncompressedSize))) {
+                sectionData[i].resize(uncompressedSize);
+
+                compressed[i].resize(section.sh_size - sizeof(uncompressedSize));
+                if(!in.read(compressed[i].data(), compressed[i].size())) {
                     LOG_ERR_AND_RETURN(RPXError::REACHED_EOF);
                 }
-                
-                size_t bufSize = uncompressedSize;
-                if(zng_uncompress(reinterpret_cast<uint8_t*>(outBuf.data()), &bufSize, reinterpret_cast<const uint8_t*>(sectionData.data()), sectionData.size()) != Z_OK) {
-                    LOG_ERR_AND_RETURN(RPXError::ZLIB_ERROR);
-                }
-                
-                out.write(outBuf.data(), bufSize);
-                section.sh_size = bufSize;
+
+                tasks.emplace_back([&input = compressed[i], &output = sectionData[i], &zlibFailed]() {
+                    size_t bufSize = output.size();
+                    if(zng_uncompress(reinterpret_cast<uint8_t*>(output.data()), &bufSize, reinterpret_cast<const uint8_t*>(input.data()), input.size()) != Z_OK) {
+                        zlibFailed = true;
+                        return;
+                    }
+                    output.resize(bufSize);
+                    std::string().swap(input);
+                });
             }
             else {
-                std::string sectionData(section.sh_size, '\0');
-                if(!in.read(sectionData.data(), sectionData.size())) {
+                sectionData[i].resize(section.sh_size);
+                if(!in.read(sectionData[i].data(), sectionData[i].size())) {
                     LOG_ERR_AND_RETURN(RPXError::REACHED_EOF);
                 }
+            }
+        }
+
+        Utility::runTasks(tasks, pool);
+        if(zlibFailed) {
+            LOG_ERR_AND_RETURN(RPXError::ZLIB_ERROR);
+        }
 
-                out.write(sectionData.data(), sectionData.size());
+        for(size_t i = 0; i < sectionHeaders.size(); i++) {
+            Elf32_Shdr& section = sectionHeaders[i].second;
+            if(section.sh_offset == 0) {
+                continue;
             }
-            
+
+            section.sh_offset = out.tellp();
+            out.write(sectionData[i].data(), sectionData[i].size());
+            section.sh_size = sectionData[i].size();
+            std::string().swap(sectionData[i]);
+
             padToLen(out, 0x40);
         }
         
@@ -262,7 +297,7 @@ namespace FileTypes {
         return RPXError::NONE;
     }
 
-    RPXError rpx_compress(std::istream& in, std::ostream& out)
+    RPXError rpx_compress(std::istream& in, std::ostream& out, Utility::WorkStealingPool* pool)
     {
         Elf32_Ehdr header{};
 
@@ -383,46 +418,72 @@ namespace FileTypes {
         std::ranges::sort(sectionHeaders, [](const shdr_index_t& a, const shdr_index_t& b) { return a.second.sh_offset < b.second.sh_offset; });
         Utility::seek(out, 0x40 + header.e_shentsize * header.e_shnum);
 
+        // read every section first, CRCs and compression run in parallel and the output is written in offset order afterwards
         std::vector<uint32_t> crcs(sectionHeaders.size(), 0);
-        for(auto& [index, section] : sectionHeaders) {
+        std::vector<std::string> sectionData(sectionHeaders.size());
+        std::vector<std::string> compressed(sectionHeaders.size());
+        std::vector<Utility::WorkStealingPool::Task_t> tasks;
+        std::atomic<bool> zlibFailed = false;
+        for(size_t i = 0; i < sectionHeaders.size(); i++) {
+            const Elf32_Shdr& section = sectionHeaders[i].second;
             if(section.sh_offset == 0) {
                 continue;
             }
 
             in.seekg(section.sh_offset, std::ios::beg);
-            std::string sectionData(section.sh_size, '\0');
-            if(!in.read(sectionData.data(), sectionData.size())) {
+            sectionData[i].resize(section.sh_size);
+            if(!in.read(sectionData[i].data(), sectionData[i].size())) {
                 LOG_ERR_AND_RETURN(RPXError::REACHED_EOF);
             }
 
-            if(section.sh_type != SectionType::SHT_RPL_CRCS) {
-                crcs[index] = zng_crc32(0, reinterpret_cast<const uint8_t*>(sectionData.data()), sectionData.size());
-            }
-            section.sh_offset = out.tellp();
-
-            if(section.sh_flags & static_cast<std::underlying_type_t<SectionFlags>>(SectionFlags::SHF_DEFLATED)) {
-                uint32_t uncompressedSize = sectionData.size();
+            tasks.emplace_back([&section, &input = sectionData[i], &output = compressed[i], &crc = crcs[sectionHeaders[i].first], &zlibFailed]() {
+                if(section.sh_type != SectionType::SHT_RPL_CRCS) {
+                    crc = zng_crc32(0, reinterpret_cast<const uint8_t*>(input.data()), input.size());
+                }
 
-                std::string outBuf(zng_compressBound(uncompressedSize), '\0');
+                if(isDeflated(section)) {
+                    output.resize(zng_compressBound(input.size()));
 
-                size_t bufSize = outBuf.size(); // updated by zng_compress
-                if(zng_compress(reinterpret_cast<uint8_t*>(outBuf.data()), &bufSize, reinterpret_cast<const uint8_t*>(sectionData.data()), sectionData.size()) != Z_OK) {
-                    LOG_ERR_AND_RETURN(RPXError::ZLIB_ERROR);
+                    size_t bufSize = output.size(); // updated by zng_compress
+                    if(zng_compress(reinterpret_cast<uint8_t*>(output.data()), &bufSize, reinterpret_cast<const uint8_t*>(input.data()), input.size()) != Z_OK) {
+                        zlibFailed = true;
+                        return;
+                    }
+                    output.resize(bufSize);
                 }
-                
+            });
+        }
+
+        Utility::runTasks(tasks, pool);
+        if(zlibFailed) {
+            LOG_ERR_AND_RETURN(RPXError::ZLIB_ERROR);
+        }
+
+        for(size_t i = 0; i < sectionHeaders.size(); i++) {
+            Elf32_Shdr& section = sectionHeaders[i].second;
+            if(section.sh_offset == 0) {
+                continue;
+            }
+
+            section.sh_offset = out.tellp();
+
+            if(isDeflated(section)) {
                 // uncompressed size is stored at the start of each compressed section
+                uint32_t uncompressedSize = sectionData[i].size();
                 Utility::Endian::toPlatform_inplace(eType::Big, uncompressedSize);
                 if(!out.write(reinterpret_cast<const char*>(&uncompressedSize), sizeof(uncompressedSize))) {
                     LOG_ERR_AND_RETURN(RPXError::REACHED_EOF);
                 }
 
-                out.write(outBuf.data(), bufSize);
-                section.sh_size = bufSize + 4; // 32-bit int for uncompressed size is included in the section size
+                out.write(compressed[i].data(), compressed[i].size());
+                section.sh_size = compressed[i].size() + 4; // 32-bit int for uncompressed size is included in the section size
             }
             else {
-                out.write(sectionData.data(), sectionData.size());
+                out.write(sectionData[i].data(), sectionData[i].size());
             }
-            
+            std::string().swap(sectionData[i]);
+            std::string().swap(compressed[i]);
+
             padToLen(out, 0x40);
         }
 
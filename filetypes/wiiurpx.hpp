@@ -19,9 +19,14 @@ enum struct [[nodiscard]] RPXError {
     COUNT
 };
 
+namespace Utility {
+    class WorkStealingPool;
+}
+
 namespace FileTypes {
     const char* RPXErrorGetName(RPXError err);
 
-    RPXError rpx_decompress(std::istream& in, std::ostream& out);
-    RPXError rpx_compress(std::istream& in, std::ostream& out);
+    // sections are (de)compressed on the pool if one is given, nullptr to do them serially
+    RPXError rpx_decompress(std::istream& in, std::ostream& out, Utility::WorkStealingPool* pool = nullptr);
+    RPXError rpx_compress(std::istream& in, std::ostream& out, Utility::WorkStealingPool* pool = nullptr);
 }
@@ -2,84 +2,53 @@
 
 #include <string>
 #include <cstring>
-#include <bitset>
 #include <sstream>
+#include <iterator>
+#include <vector>
+#include <algorithm>
 
 #include <utility/endian.hpp>
 #include <utility/math.hpp>
+#include <utility/work_pool.hpp>
 #include <command/Log.hpp>
 
-struct Yaz0Header 
-{
-    char magic[4];
-    uint32_t uncompressedSize;
-    char _unused0[8];
-};
-
 namespace {
-    YAZ0Error readYaz0Header(std::istream& in, Yaz0Header& header)
-    {
-        if(!in.read(header.magic, sizeof(header.magic))) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
-        // check magic string in header
-        if(std::strncmp(header.magic, "Yaz0", 4) != 0) LOG_ERR_AND_RETURN(YAZ0Error::NOT_YAZ0);
-        if(!in.read(reinterpret_cast<char*>(&header.uncompressedSize), sizeof(header.uncompressedSize))) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
-        Utility::Endian::toPlatform_inplace(Utility::Endian::Type::Big, header.uncompressedSize);
-        if(!in.read(header._unused0, sizeof(header._unused0))) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
-        return YAZ0Error::NONE;
-    }
-    
-    YAZ0Error yaz0DataDecode(const char* in, char* out, uint32_t outTotalSize)
-    {
-        uint32_t runLength = 0, runOffset = 0;
-        uint8_t codeInfoBlockMSB = 0, codeInfoBlockLSB = 0;
-        uint8_t codingModeByte = 0;
-        uint8_t validCodingBitCount = 0;
-        char* lastByte = out + outTotalSize;
-        while(out < lastByte)
-        {
-            if(validCodingBitCount == 0)
-            {
-                codingModeByte = *(in++);
-                validCodingBitCount = 8;
+    constexpr size_t YAZ0_HEADER_SIZE = 0x10;
+    constexpr size_t COPY_SLACK = 15; //runs may write this far past their end when there's room
+
+    // Copies a back-reference, in blocks where there's room to overrun (the extra bytes are overwritten by later ops)
+    void copyRun(char* dst, const size_t& dist, const size_t& len, const char* dstEnd) {
+        const char* src = dst - dist;
+        if(static_cast<size_t>(dstEnd - dst) < len + COPY_SLACK) {
+            for(size_t i = 0; i < len; i++) {
+                dst[i] = src[i];
             }
-    
-            if((codingModeByte & 0x80) == 0)
-            {
-                // read two bytes for coding information
-                codeInfoBlockMSB = in[0];
-                codeInfoBlockLSB = in[1];
-                in += 2;
-                runOffset = ((codeInfoBlockMSB & 0x0F) << 8) | codeInfoBlockLSB;
-                runLength = codeInfoBlockMSB >> 4;
-                // if upper nibble is zero, run length is in (optional) third code info byte
-                if(runLength == 0)
-                {
-                    runLength = *(reinterpret_cast<const uint8_t*>(in++));
-                    runLength += 0x12;
-                }
-                else
-                {
-                    runLength += 2;
-                }
-                char* pRun = out - runOffset - 1;
-                char* pEndRun = pRun + runLength;
-                while(pRun < pEndRun)
-                {
-                    // copy from run location and advance
-                    *(out++) = *(pRun++);
-                }
+            return;
+        }
+
+        // blocks can't overlap their own source once the distance is at least the block size
+        if(dist >= 16) {
+            for(size_t i = 0; i < len; i += 16) {
+                std::memcpy(dst + i, src + i, 16);
             }
-            else 
-            {
-                // copy single byte and move both pointers forward one
-                *(out++) = *(in++);
+        }
+        else if(dist >= 8) {
+            for(size_t i = 0; i < len; i += 8) {
+                std::memcpy(dst + i, src + i, 8);
+            }
+        }
+        else {
+            // short distances repeat a pattern, write it 8 bytes at a time and step by a multiple of the distance
+            char pattern[8];
+            for(size_t i = 0; i < sizeof(pattern); i++) {
+                pattern[i] = src[i % dist];
+            }
+
+            const size_t step = 8 - 8 % dist;
+            for(size_t i = 0; i < len; i += step) {
+                std::memcpy(dst + i, pattern, 8);
             }
-    
-            codingModeByte <<= 1;
-            validCodingBitCount -= 1;
         }
-    
-        return YAZ0Error::NONE;
     }
 }
 
@@ -353,7 +322,349 @@ uint32_t Compressor::encode(uint8_t* p_dst, const uint8_t* p_src, uint32_t src_s
 	return out_size;
 }
 
+// Parallel encoding
+// Each segment is parsed on its own with its match window primed from the data before it
+// The op chosen at a position only depends on the data, not on earlier ops, so once a segment's parse lands on a
+// position the next segment's parse also started an op at, everything after matches a serial parse
+// Segments keep parsing a little past their end to find that position, if there isn't one the boundary is clipped
+namespace {
+    constexpr uint32_t WINDOW_SIZE = 0x1000;
+    constexpr uint32_t MIN_MATCH = 3;
+    constexpr uint32_t MAX_MATCH = 0x111;
+    constexpr uint32_t HASH_SIZE = 0x8000;
+    constexpr size_t SYNC_DISTANCE = 0x4000; //how far past its end a segment looks for a position shared with the next one
+    constexpr size_t MIN_SEGMENT_SIZE = 0x40000;
+    constexpr size_t BOUNDARY_COST = 0x140; //roughly the most a boundary that doesn't line up can add, a max length match as literals
+    constexpr size_t OPTIMAL_BLOCK_SIZE = 0x10000; //optimal parsing is done in blocks to keep its tables small
+
+    struct ParseParams {
+        uint32_t maxChain; //candidates checked per position
+        bool lazy; //check if the next position has a longer match before taking one
+    };
+
+    constexpr ParseParams getParseParams(const FileTypes::Yaz0Profile& profile) {
+        switch(profile) {
+            case FileTypes::Yaz0Profile::FAST:
+                return {16, false};
+            case FileTypes::Yaz0Profile::OPTIMAL: //picks lengths itself, only needs the longest match
+                return {WINDOW_SIZE, false};
+            case FileTypes::Yaz0Profile::BALANCED:
+            default:
+                return {WINDOW_SIZE, true};
+        }
+    }
+
+    struct Op {
+        size_t pos = 0;
+        uint32_t len = 0;
+        uint32_t dist = 0; //0 for literals
+    };
+
+    // Hash chains over the window, every position before the one being searched is inserted in order
+    class MatchFinder {
+    public:
+        MatchFinder(const uint8_t* data_, const size_t& size_, const size_t& start, const ParseParams& params_) :
+            data(data_),
+            size(size_),
+            params(params_),
+            head(HASH_SIZE, -1),
+            prev(WINDOW_SIZE, -1),
+            inserted(start > WINDOW_SIZE ? start - WINDOW_SIZE : 0) //primes the window with the previous segment's tail
+        {}
+
+        Op next(const size_t& pos) {
+            const Op op = find(pos);
+
+            // take a literal instead if the next position has a longer match
+            if(params.lazy && op.len >= MIN_MATCH && op.len < MAX_MATCH && find(pos + 1).len > op.len) {
+                return {pos, 1, 0};
+            }
+
+            return op;
+        }
+
+        Op find(const size_t& pos) { //longest match at this position, or a literal
+            for(; inserted < pos; inserted++) {
+                if(inserted + MIN_MATCH > size) continue;
+
+                const uint32_t h = hash(inserted);
+                prev[inserted % WINDOW_SIZE] = head[h];
+                head[h] = static_cast<int32_t>(inserted);
+            }
+
+            Op best{pos, 1, 0};
+            if(pos + MIN_MATCH > size) return best;
+
+            const size_t maxLen = std::min<size_t>(MAX_MATCH, size - pos);
+            int32_t cand = head[hash(pos)];
+            for(uint32_t checked = 0; cand >= 0 && pos - cand <= WINDOW_SIZE && checked < params.maxChain; checked++) {
+                // can't beat the current best unless the byte after it matches too
+                if(data[cand + best.len] == data[pos + best.len]) {
+                    uint32_t len = 0;
+                    while(len < maxLen && data[cand + len] == data[pos + len]) len++;
+
+                    if(len > best.len) {
+                        best = {pos, len, static_cast<uint32_t>(pos - cand)};
+                        if(len == maxLen) break;
+                    }
+                }
+
+                const int32_t older = prev[cand % WINDOW_SIZE];
+                if(older >= cand) break; //slot was reused by a newer position
+                cand = older;
+            }
+
+            if(best.len < MIN_MATCH) return {pos, 1, 0};
+            return best;
+        }
+
+    private:
+        const uint8_t* data;
+        size_t size;
+        ParseParams params;
+        std::vector<int32_t> head;
+        std::vector<int32_t> prev;
+        size_t inserted;
+
+        uint32_t hash(const size_t& pos) const {
+            return ((data[pos] << 10) ^ (data[pos + 1] << 5) ^ data[pos + 2]) & (HASH_SIZE - 1);
+        }
+    };
+
+    void appendOp(std::vector<uint8_t>& payload, std::vector<bool>& literals, const uint8_t* data, const Op& op) {
+        literals.push_back(op.dist == 0);
+        if(op.dist == 0) {
+            payload.push_back(data[op.pos]);
+            return;
+        }
+
+        const uint32_t code = op.dist - 1;
+        if(op.len < 0x12) {
+            payload.push_back(static_cast<uint8_t>(((op.len - 2) << 4) | (code >> 8)));
+            payload.push_back(static_cast<uint8_t>(code));
+        }
+        else {
+            payload.push_back(static_cast<uint8_t>(code >> 8));
+            payload.push_back(static_cast<uint8_t>(code));
+            payload.push_back(static_cast<uint8_t>(op.len - 0x12));
+        }
+    }
+
+    struct Segment {
+        struct Head {
+            size_t pos;
+            size_t opIndex;
+            size_t payloadOffset;
+        };
+
+        size_t end = 0;
+        std::vector<uint8_t> payload; //encoded ops, flags are added when the segments are joined
+        std::vector<bool> literals;
+        std::vector<Head> heads; //ops starting within SYNC_DISTANCE of the segment start
+        Op last; //the op that reaches the end, may run past it
+        std::vector<Op> extension; //parsed past the end to find where the next segment lines up
+    };
+
+    void encodeSegment(const uint8_t* data, const size_t& size, const size_t& start, const ParseParams& params, Segment& segment) {
+        MatchFinder finder(data, size, start, params);
+
+        size_t pos = start;
+        while(true) {
+            const Op op = finder.next(pos);
+            if(pos - start < SYNC_DISTANCE) {
+                segment.heads.push_back({pos, segment.literals.size(), segment.payload.size()});
+            }
+            if(pos + op.len >= segment.end) {
+                segment.last = op;
+                pos += op.len;
+                break;
+            }
+
+            appendOp(segment.payload, segment.literals, data, op);
+            pos += op.len;
+        }
+
+        const size_t extensionEnd = std::min(size, segment.end + SYNC_DISTANCE);
+        while(pos < extensionEnd) {
+            const Op op = finder.next(pos);
+            segment.extension.push_back(op);
+            pos += op.len;
+        }
+    }
+
+    // Picks the cheapest set of ops for each block instead of taking matches as they come
+    // Any length up to the longest match at a position can be used with the same distance
+    // Segments are parsed up to their end exactly, so they don't fill the sync data
+    void encodeSegmentOptimal(const uint8_t* data, const size_t& size, const size_t& start, Segment& segment) {
+        MatchFinder finder(data, size, start, getParseParams(FileTypes::Yaz0Profile::OPTIMAL));
+
+        std::vector<uint16_t> longest(OPTIMAL_BLOCK_SIZE);
+        std::vector<uint16_t> dists(OPTIMAL_BLOCK_SIZE);
+        std::vector<uint32_t> cost(OPTIMAL_BLOCK_SIZE + 1); //in bits, from this position to the end of the block
+        std::vector<uint16_t> chosen(OPTIMAL_BLOCK_SIZE);
+
+        for(size_t blockStart = start; blockStart < segment.end; blockStart += OPTIMAL_BLOCK_SIZE) {
+            const size_t blockSize = std::min(OPTIMAL_BLOCK_SIZE, segment.end - blockStart);
+            for(size_t i = 0; i < blockSize; i++) {
+                const Op op = finder.find(blockStart + i);
+                longest[i] = static_cast<uint16_t>(std::min<size_t>(op.len, blockSize - i)); //matches stop at the block end
+                dists[i] = static_cast<uint16_t>(op.dist);
+            }
+
+            cost[blockSize] = 0;
+            for(size_t i = blockSize; i-- > 0; ) {
+                cost[i] = 9 + cost[i + 1]; //flag bit + literal
+                chosen[i] = 1;
+                if(longest[i] < MIN_MATCH) continue;
+
+                for(uint32_t len = MIN_MATCH; len <= longest[i]; len++) {
+                    const uint32_t matchCost = (len < 0x12 ? 17 : 25) + cost[i + len];
+                    if(matchCost < cost[i]) {
+                        cost[i] = matchCost;
+                        chosen[i] = static_cast<uint16_t>(len);
+                    }
+                }
+            }
+
+            for(size_t i = 0; i < blockSize; i += chosen[i]) {
+                const Op op = chosen[i] == 1 ? Op{blockStart + i, 1, 0} : Op{blockStart + i, chosen[i], dists[i]};
+                if(blockStart + i + op.len == segment.end) {
+                    segment.last = op;
+                    break;
+                }
+                appendOp(segment.payload, segment.literals, data, op);
+            }
+        }
+    }
+
+    // Adds the flag bytes while copying ops into the final stream
+    class GroupWriter {
+    public:
+        explicit GroupWriter(std::vector<uint8_t>& out_) : out(out_) {}
+
+        void write(const bool& literal, const uint8_t* payload, const size_t& len) {
+            if(bit == 8) {
+                flagOffset = out.size();
+                out.push_back(0);
+                bit = 0;
+            }
+
+            if(literal) out[flagOffset] |= 0x80 >> bit;
+            bit++;
+            out.insert(out.end(), payload, payload + len);
+        }
+
+        void write(const uint8_t* data, const Op& op) {
+            std::vector<uint8_t> payload;
+            std::vector<bool> literal;
+            appendOp(payload, literal, data, op);
+            write(literal[0], payload.data(), payload.size());
+        }
+
+    private:
+        std::vector<uint8_t>& out;
+        size_t flagOffset = 0;
+        uint8_t bit = 8;
+    };
+
+    void yaz0EncodeSegments(const uint8_t* data, const size_t& size, const size_t& numSegments, const FileTypes::Yaz0EncodeOptions& options, std::vector<uint8_t>& out) {
+        std::vector<Segment> segments(numSegments);
+        std::vector<Utility::WorkStealingPool::Task_t> tasks;
+        tasks.reserve(numSegments);
+        for(size_t i = 0; i < numSegments; i++) {
+            const size_t start = size * i / numSegments;
+            segments[i].end = size * (i + 1) / numSegments;
+            tasks.emplace_back([data, size, start, profile = options.profile, &segment = segments[i]]() {
+                if(profile == FileTypes::Yaz0Profile::OPTIMAL) {
+                    encodeSegmentOptimal(data, size, start, segment);
+                }
+                else {
+                    encodeSegment(data, size, start, getParseParams(profile), segment);
+                }
+            });
+        }
+
+        Utility::runTasks(tasks, options.pool);
+
+        GroupWriter writer(out);
+        size_t skipOps = 0;
+        size_t skipPayload = 0;
+        for(size_t i = 0; i < numSegments; i++) {
+            Segment& segment = segments[i];
+            for(size_t op = skipOps, offset = skipPayload; op < segment.literals.size(); op++) {
+                size_t len = 1;
+                if(!segment.literals[op]) {
+                    len = (segment.payload[offset] >> 4) == 0 ? 3 : 2;
+                }
+                writer.write(segment.literals[op], &segment.payload[offset], len);
+                offset += len;
+            }
+            std::vector<uint8_t>().swap(segment.payload);
+
+            if(i + 1 == numSegments) {
+                writer.write(data, segment.last);
+                break;
+            }
+
+            // find the first position both parses start an op at
+            const std::vector<Segment::Head>& heads = segments[i + 1].heads;
+            size_t pos = segment.last.pos + segment.last.len;
+            size_t ext = 0;
+            auto head = heads.begin();
+            while(true) {
+                while(head != heads.end() && head->pos < pos) head++;
+                if(head == heads.end() || head->pos == pos || ext == segment.extension.size()) break;
+                pos += segment.extension[ext++].len;
+            }
+
+            if(head != heads.end() && head->pos == pos) {
+                writer.write(data, segment.last);
+                for(size_t op = 0; op < ext; op++) {
+                    writer.write(data, segment.extension[op]);
+                }
+                skipOps = head->opIndex;
+                skipPayload = head->payloadOffset;
+                continue;
+            }
+
+            // no common position, cut the last op off at the boundary and start the next segment there
+            const size_t remaining = segment.end - segment.last.pos;
+            if(remaining >= MIN_MATCH) {
+                writer.write(data, {segment.last.pos, static_cast<uint32_t>(remaining), segment.last.dist});
+            }
+            else {
+                for(size_t offset = 0; offset < remaining; offset++) {
+                    writer.write(data, {segment.last.pos + offset, 1, 0});
+                }
+            }
+            skipOps = 0;
+            skipPayload = 0;
+        }
+    }
+}
+
 namespace FileTypes {
+	std::string Yaz0ProfileToName(const Yaz0Profile& profile) {
+		switch (profile) {
+			case Yaz0Profile::FAST:
+				return "Fast";
+			case Yaz0Profile::BALANCED:
+				return "Balanced";
+			case Yaz0Profile::OPTIMAL:
+				return "Optimal";
+			default:
+				return "INVALID";
+		}
+	}
+
+	Yaz0Profile nameToYaz0Profile(const std::string& name) {
+		for(const Yaz0Profile& profile : {Yaz0Profile::FAST, Yaz0Profile::BALANCED, Yaz0Profile::OPTIMAL}) {
+			if(name == Yaz0ProfileToName(profile)) return profile;
+		}
+
+		return Yaz0Profile::INVALID;
+	}
+
 	const char* YAZ0ErrorGetName(YAZ0Error err) {
 		switch (err) {
 			case YAZ0Error::NONE:
@@ -366,65 +677,158 @@ namespace FileTypes {
 				return "ZNG_ERROR";
 			case YAZ0Error::REACHED_EOF:
 				return "REACHED_EOF";
+			case YAZ0Error::INVALID_REFERENCE:
+				return "INVALID_REFERENCE";
 			default:
 				return "UNKNOWN";
 		}
 	}
 
-	//TODO: not thread-safe
-	//larger buffer is faster, but too large for stack
-	constexpr uint32_t STATIC_READ_CHUNK_SIZE = 1024 * 1024 * 2;
-	static char readChunkBuf[STATIC_READ_CHUNK_SIZE];
+	YAZ0Error Yaz0Decoder::init(std::span<const char> in_)
+	{
+		if(in_.size() < YAZ0_HEADER_SIZE) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
+		if(std::strncmp(in_.data(), "Yaz0", 4) != 0) LOG_ERR_AND_RETURN(YAZ0Error::NOT_YAZ0);
+
+		decodedSize = *reinterpret_cast<const uint32_t*>(&in_[4]);
+		Utility::Endian::toPlatform_inplace(Utility::Endian::Type::Big, decodedSize);
 
-	YAZ0Error yaz0Decode(std::istream& in, std::ostream& out)
+		in = in_;
+		inPos = YAZ0_HEADER_SIZE;
+		outPos = 0;
+		flags = 0;
+		flagBits = 0;
+
+		return YAZ0Error::NONE;
+	}
+
+	YAZ0Error Yaz0Decoder::decode(std::span<char> out, const size_t& length)
 	{
-		std::string inData{};
+		if(out.size() < decodedSize) LOG_ERR_AND_RETURN(YAZ0Error::UNKNOWN);
+
+		const uint8_t* src = reinterpret_cast<const uint8_t*>(in.data()) + inPos;
+		const uint8_t* const srcEnd = reinterpret_cast<const uint8_t*>(in.data()) + in.size();
+		char* const dstBegin = out.data();
+		char* const dstEnd = dstBegin + decodedSize;
+		char* const dstStop = dstBegin + std::min<size_t>(length, decodedSize);
+		char* dst = dstBegin + outPos;
+
+		while(dst < dstStop) {
+			if(flagBits == 0) {
+				if(src == srcEnd) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
+				flags = *src++;
+				flagBits = 8;
+
+				// a whole group of literals is a straight copy
+				if(flags == 0xFF && srcEnd - src >= 8 && dstEnd - dst >= 8) {
+					std::memcpy(dst, src, 8);
+					src += 8;
+					dst += 8;
+					flagBits = 0;
+					continue;
+				}
+			}
 
-		Yaz0Header header{};
+			if(flags & 0x80) {
+				if(src == srcEnd) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
+				*dst++ = static_cast<char>(*src++);
+			}
+			else {
+				if(srcEnd - src < 2) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
+				const size_t dist = (((src[0] & 0x0F) << 8) | src[1]) + 1;
+				size_t len = src[0] >> 4;
+				src += 2;
+
+				// if upper nibble is zero, run length is in the third byte
+				if(len == 0) {
+					if(src == srcEnd) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
+					len = *src++ + 0x12;
+				}
+				else {
+					len += 2;
+				}
 
-		LOG_AND_RETURN_IF_ERR(readYaz0Header(in, header));
+				if(dist > static_cast<size_t>(dst - dstBegin)) LOG_ERR_AND_RETURN(YAZ0Error::INVALID_REFERENCE);
+				len = std::min<size_t>(len, dstEnd - dst);
 
-		// IMPROVEMENT: for now we are reading entire file into memory
-		// and allocating a full size output buffer. This can
-		// take up quite a lot of memory, so if it becomes a
-		// problem, we can switch to decoding as chunks. This
-		// will make decoding _slightly_ slower, but much more
-		// memory efficient
+				copyRun(dst, dist, len, dstEnd);
+				dst += len;
+			}
 
-		// read rest of file into memory
-		while(in.read(readChunkBuf, STATIC_READ_CHUNK_SIZE))
-		{
-			inData.append(readChunkBuf, in.gcount());
+			flags <<= 1;
+			flagBits--;
 		}
-		inData.append(readChunkBuf, in.gcount());
 
-		std::string outData(header.uncompressedSize, '\0'); //string instead of char array to avoid manual deletion
-		LOG_AND_RETURN_IF_ERR(yaz0DataDecode(inData.data(), &outData[0], header.uncompressedSize));
-		out.write(&outData[0], header.uncompressedSize);
+		inPos = src - reinterpret_cast<const uint8_t*>(in.data());
+		outPos = dst - dstBegin;
+		return YAZ0Error::NONE;
+	}
+
+	YAZ0Error yaz0Decode(std::istream& in, std::ostream& out)
+	{
+		const std::string inData{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+		Yaz0Decoder decoder;
+		LOG_AND_RETURN_IF_ERR(decoder.init(inData));
+
+		std::vector<char> outData(decoder.getDecodedSize());
+		LOG_AND_RETURN_IF_ERR(decoder.decode(outData, outData.size()));
+		out.write(outData.data(), outData.size());
 
 		return YAZ0Error::NONE;
 	}
 
-	YAZ0Error yaz0Decode(std::stringstream& in, std::ostream& out)
+	uint32_t yaz0GetDecodedSize(std::istream& in)
 	{
-		Yaz0Header header{};
+		char header[8];
+		if(!in.read(header, sizeof(header))) return 0;
+		if(std::strncmp(header, "Yaz0", 4) != 0) return 0;
+
+		uint32_t uncompressedSize = *reinterpret_cast<const uint32_t*>(&header[4]);
+		Utility::Endian::toPlatform_inplace(Utility::Endian::Type::Big, uncompressedSize);
+		return uncompressedSize;
+	}
 
-		LOG_AND_RETURN_IF_ERR(readYaz0Header(in, header));
+	YAZ0Error yaz0Decode(std::span<const char> in, Utility::ByteStream& out)
+	{
+		Yaz0Decoder decoder;
+		LOG_AND_RETURN_IF_ERR(decoder.init(in));
 
-		std::string outData(header.uncompressedSize, '\0'); //string instead of char array to avoid manual deletion
-		LOG_AND_RETURN_IF_ERR(yaz0DataDecode(&in.str()[0x10], &outData[0], header.uncompressedSize));
-		out.write(&outData[0], header.uncompressedSize);
+		out.resize(decoder.getDecodedSize());
+		LOG_AND_RETURN_IF_ERR(decoder.decode(out.span(), out.size()));
 
 		return YAZ0Error::NONE;
 	}
 	
-	YAZ0Error yaz0Encode(const std::stringstream& in, std::ostream& out, uint32_t compressionLevel)
+	YAZ0Error yaz0Encode(std::span<const char> in, Utility::ByteStream& out, const Yaz0EncodeOptions& options)
 	{
-		const std::string& inData = in.str();
-    	std::vector<uint8_t> tmp(16 + roundUp<size_t>(inData.size(), 8) / 8 * 9 - 1);
+		size_t numSegments = 1;
+		if(options.pool != nullptr && in.size() >= MIN_SEGMENT_SIZE * 2) {
+			// rough estimate, assumes the output is at least an 8th of the input
+			const double allowedGrowth = (options.maxSizeRatio - 1.0) * (in.size() / 8.0);
+			numSegments = std::min({in.size() / MIN_SEGMENT_SIZE, options.pool->getThreadCount() * 4, size_t(1) + static_cast<size_t>(std::max(allowedGrowth, 0.0) / BOUNDARY_COST)});
+		}
+
+		// balanced keeps using the MK8 encoder when there's nothing to split
+		if(numSegments > 1 || (options.profile != Yaz0Profile::BALANCED && !in.empty())) {
+			std::vector<uint8_t> encoded;
+			encoded.reserve(in.size() / 2);
+			encoded.insert(encoded.end(), {'Y', 'a', 'z', '0'});
+			for(int shift = 24; shift >= 0; shift -= 8) {
+				encoded.push_back(static_cast<uint8_t>(in.size() >> shift));
+			}
+			encoded.resize(0x10, 0);
+
+			yaz0EncodeSegments(reinterpret_cast<const uint8_t*>(in.data()), in.size(), numSegments, options, encoded);
+			out.assign({reinterpret_cast<const char*>(encoded.data()), encoded.size()});
+
+			return YAZ0Error::NONE;
+		}
+
+		// worst case size, trimmed after encoding
+		out.resize(16 + roundUp<size_t>(in.size(), 8) / 8 * 9 - 1);
 		std::vector<uint8_t> work(Compressor::getRequiredMemorySize());
-		const uint32_t outSize = Compressor::encode(tmp.data(), reinterpret_cast<const uint8_t*>(inData.data()), inData.size(), work.data());
-		out.write(reinterpret_cast<const char*>(tmp.data()), outSize);
+		const uint32_t outSize = Compressor::encode(reinterpret_cast<uint8_t*>(out.data()), reinterpret_cast<const uint8_t*>(in.data()), in.size(), work.data());
+		out.resize(outSize);
 
 		return YAZ0Error::NONE;
 	}
@@ -5,6 +5,10 @@
 
 #include <cstdint>
 #include <fstream>
+#include <span>
+#include <string>
+
+#include <utility/buffer.hpp>
 
 
 
@@ -14,15 +18,56 @@ enum struct [[nodiscard]] YAZ0Error {
     NOT_YAZ0,
     ZNG_ERROR,
     REACHED_EOF,
+    INVALID_REFERENCE,
     UNKNOWN,
     COUNT
 };
 
+namespace Utility {
+    class WorkStealingPool;
+}
+
 namespace FileTypes {
+    enum struct Yaz0Profile {
+        FAST = 0, //greedy matching with short searches, for builds where encode time matters more than size
+        BALANCED, //MK8 encoder, lazy matching when split into segments
+        OPTIMAL, //picks the cheapest ops per block, smallest output but slowest
+        INVALID
+    };
+
+    std::string Yaz0ProfileToName(const Yaz0Profile& profile);
+    Yaz0Profile nameToYaz0Profile(const std::string& name);
+
+    struct Yaz0EncodeOptions {
+        Yaz0Profile profile = Yaz0Profile::BALANCED;
+        Utility::WorkStealingPool* pool = nullptr; //large inputs are split into segments encoded on this pool, nullptr to always encode serially
+        double maxSizeRatio = 1.01; //limits the number of segments so the output stays within roughly this ratio of a serial encode
+    };
+
     const char* YAZ0ErrorGetName(YAZ0Error err);
 
+    // Decodes into a caller-provided buffer as far as it's asked to
+    // Lets a parser start on the beginning of the data (like a SARC header) before the rest is decoded
+    class Yaz0Decoder {
+    public:
+        YAZ0Error init(std::span<const char> in_); //reads the header, in_ has to stay valid until decoding is done
+        uint32_t getDecodedSize() const { return decodedSize; }
+        YAZ0Error decode(std::span<char> out, const size_t& length); //until at least length bytes are decoded, out must be the same buffer every call and hold getDecodedSize() bytes
+        size_t getDecodedLength() const { return outPos; }
+        bool isFinished() const { return outPos == decodedSize; }
+
+    private:
+        std::span<const char> in;
+        size_t inPos = 0;
+        size_t outPos = 0;
+        uint32_t decodedSize = 0;
+        uint8_t flags = 0;
+        uint8_t flagBits = 0;
+    };
+
     YAZ0Error yaz0Decode(std::istream& in, std::ostream& out);
-    YAZ0Error yaz0Decode(std::stringstream& in, std::ostream& out);
+    YAZ0Error yaz0Decode(std::span<const char> in, Utility::ByteStream& out); //decodes directly into out's buffer
     //YAZ0Error yaz0Encode(std::istream& in, std::ostream& out, uint32_t compressionLevel = 9);
-    YAZ0Error yaz0Encode(const std::stringstream& in, std::ostream& out, uint32_t compressionLevel = 9);
+    YAZ0Error yaz0Encode(std::span<const char> in, Utility::ByteStream& out, const Yaz0EncodeOptions& options = {}); //encodes directly into out's buffer
+    uint32_t yaz0GetDecodedSize(std::istream& in); //reads the header only, returns 0 if the data isn't YAZ0 (not logged)
 }
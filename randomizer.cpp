@@ -6,6 +6,8 @@
 
 #include <libs/tinyxml2.hpp>
 #include <libs/zlib-ng.hpp>
+#include <libs/hashing.hpp>
+#include <libs/yaml.hpp>
 
 #include <tweaks.hpp>
 #include <seedgen/config.hpp>
@@ -165,10 +167,16 @@ public:
         
         // Only set up the session if we actually need it
         if(!dryRun) {
+            g_session.setUseDecodeCache(config.useDecodeCache);
+            g_session.setIncrementalOutput(config.incrementalOutput);
             if(!g_session.init(config.gameBaseDir, config.outputDir)) {
                 ErrorLog::getInstance().log("Failed to initialize session");
                 return 1;
             }
+            g_session.setYaz0Profile(config.yaz0Profile);
+            g_session.setNestedYaz0Profile(config.nestedYaz0Profile);
+            g_session.setMemoryBudget(config.repackMemoryBudgetMB * 1024 * 1024);
+            g_session.setSyncOutput(config.syncOutput);
             Utility::platformLog("Initialized session");
         }
 
@@ -213,6 +221,9 @@ public:
         if(!verifyOutput()) {
             return 1;
         }
+
+        // Model edits don't report what they depend on, files they touch are always rebuilt
+        g_session.setActionKey("");
         if (!config.settings.selectedModel.custom) {
             //IMPROVEMENT: custom model things
             if (const ModelError err = config.settings.selectedModel.applyModel(); err != ModelError::NONE) {
@@ -226,7 +237,19 @@ public:
                 return 1;
             }
         }
-        
+
+
+        // Everything past here is determined by the permalink and preferences
+        // Files that only have these edits are skipped if they match the last output
+        // Some preferences only change how the files get written, not what ends up in them
+        YAML::Node preferencesRoot = config.preferencesToYaml();
+        for (const char* key : {"decode_cache", "incremental_output", "repack_memory_budget_mb", "sync_output"}) {
+            preferencesRoot.remove(key);
+        }
+        YAML::Emitter preferences;
+        preferences << preferencesRoot;
+        SHA1 outputKey;
+        g_session.setActionKey(outputKey(permalink + '\n' + preferences.c_str()));
 
         Utility::platformLog("Modifying game code...");
         UPDATE_DIALOG_VALUE(30);
@@ -50,6 +50,21 @@ void Config::resetDefaultSettings() {
 
 void Config::resetDefaultPreferences(const bool& paths) {
     settings.resetDefaultPreferences(paths);
+    yaz0Profile = FileTypes::Yaz0Profile::BALANCED;
+    nestedYaz0Profile = std::nullopt;
+    #ifdef DEVKITPRO
+        useDecodeCache = false; // console storage is small and slow, decoding is faster than reading back a cache there
+        incrementalOutput = false;
+    #else
+        useDecodeCache = true;
+        incrementalOutput = true;
+    #endif
+    #ifdef REPACK_MEMORY_BUDGET_MB
+        repackMemoryBudgetMB = REPACK_MEMORY_BUDGET_MB; // builds can pick their own default
+    #else
+        repackMemoryBudgetMB = 0;
+    #endif
+    syncOutput = false;
 
     if(paths) {
         // paths and stuff that settings don't cover
@@ -106,6 +121,38 @@ ConfigError Config::loadFromFile(const fspath& filePath, const fspath& preferenc
         settings.plandomizerFile = Utility::Str::toUTF16(plandoTemp);
     #endif
 
+    // older preferences don't have this, keep the default
+    if(preferencesRoot["yaz0_profile"]) {
+        yaz0Profile = FileTypes::nameToYaz0Profile(preferencesRoot["yaz0_profile"].as<std::string>("INVALID"));
+        if(yaz0Profile == FileTypes::Yaz0Profile::INVALID) {
+            if(!ignoreErrors) {
+                return ConfigError::INVALID_VALUE;
+            }
+            else {
+                yaz0Profile = FileTypes::Yaz0Profile::BALANCED;
+            }
+        }
+    }
+
+    nestedYaz0Profile = std::nullopt;
+    if(preferencesRoot["yaz0_nested_profile"]) {
+        nestedYaz0Profile = FileTypes::nameToYaz0Profile(preferencesRoot["yaz0_nested_profile"].as<std::string>("INVALID"));
+        if(nestedYaz0Profile == FileTypes::Yaz0Profile::INVALID) {
+            if(!ignoreErrors) {
+                return ConfigError::INVALID_VALUE;
+            }
+            else {
+                nestedYaz0Profile = std::nullopt;
+            }
+        }
+    }
+
+    // older preferences don't have these either
+    GET_FIELD_NO_FAIL(preferencesRoot, "decode_cache", useDecodeCache)
+    GET_FIELD_NO_FAIL(preferencesRoot, "incremental_output", incrementalOutput)
+    GET_FIELD_NO_FAIL(preferencesRoot, "repack_memory_budget_mb", repackMemoryBudgetMB)
+    GET_FIELD_NO_FAIL(preferencesRoot, "sync_output", syncOutput)
+
     if(!root["game_version"]) {
         if(!ignoreErrors) return ConfigError::MISSING_KEY;
     }
@@ -588,6 +635,14 @@ YAML::Node Config::preferencesToYaml() const {
     SET_FIELD(preferencesRoot, "gameBaseDir", Utility::toUtf8String(gameBaseDir))
     SET_FIELD(preferencesRoot, "outputDir", Utility::toUtf8String(outputDir))
     SET_FIELD(preferencesRoot, "plandomizerFile", Utility::toUtf8String(settings.plandomizerFile))
+    SET_FIELD(preferencesRoot, "yaz0_profile", FileTypes::Yaz0ProfileToName(yaz0Profile))
+    if(nestedYaz0Profile.has_value()) {
+        SET_FIELD(preferencesRoot, "yaz0_nested_profile", FileTypes::Yaz0ProfileToName(nestedYaz0Profile.value()))
+    }
+    SET_FIELD(preferencesRoot, "decode_cache", useDecodeCache)
+    SET_FIELD(preferencesRoot, "incremental_output", incrementalOutput)
+    SET_FIELD(preferencesRoot, "repack_memory_budget_mb", repackMemoryBudgetMB)
+    SET_FIELD(preferencesRoot, "sync_output", syncOutput)
 
     SET_FIELD(preferencesRoot, "pig_color", PigColorToName(settings.pig_color))
 
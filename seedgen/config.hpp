@@ -1,10 +1,12 @@
 #pragma once
 
+#include <optional>
 #include <string>
 
 #include <libs/yaml.hpp>
 
 #include <options.hpp>
+#include <filetypes/yaz0.hpp>
 #include <utility/path.hpp>
 
 
@@ -39,6 +41,17 @@ class Config {
 public:
     fspath gameBaseDir;
     fspath outputDir;
+    FileTypes::Yaz0Profile yaz0Profile = FileTypes::Yaz0Profile::BALANCED; //how repacked files are compressed
+    std::optional<FileTypes::Yaz0Profile> nestedYaz0Profile = std::nullopt; //files inside packs, unset to use yaz0Profile
+    #ifdef DEVKITPRO
+        bool useDecodeCache = false; //keep decoded YAZ0/RPX data between runs
+        bool incrementalOutput = false; //skip rewriting output files whose inputs haven't changed
+    #else
+        bool useDecodeCache = true;
+        bool incrementalOutput = true;
+    #endif
+    size_t repackMemoryBudgetMB = 0; //roughly how much memory repacking can use at once, 0 for no limit
+    bool syncOutput = false; //make sure the output is on disk before finishing, for removable storage
 
     std::string seed;
     Settings settings;
@@ -9,7 +9,6 @@
 #include <version.hpp>
 #include <text_replacements.hpp>
 #include <libs/tinyxml2.hpp>
-#include <libs/yaml.hpp>
 #include <asm/patches/asm_constants.hpp>
 #include <filetypes/bflim.hpp>
 #include <filetypes/bflyt.hpp>
@@ -18,6 +17,7 @@
 #include <filetypes/dzx.hpp>
 #include <filetypes/elf.hpp>
 #include <filetypes/util/elfUtil.hpp>
+#include <filetypes/util/elfPatch.hpp>
 #include <filetypes/events.hpp>
 #include <filetypes/jpc.hpp>
 #include <filetypes/msbt.hpp>
@@ -56,81 +56,22 @@ using eType = Utility::Endian::Type;
 static std::unordered_map<std::string, uint32_t> custom_symbols;
 
 static TweakError Load_Custom_Symbols(const fspath& file_path) {
-    std::string file_data;
-    if(Utility::getFileContents(file_path, file_data, true)) LOG_ERR_AND_RETURN(TweakError::DATA_FILE_MISSING);
-
-    YAML::Node symbols = YAML::Load(file_data);
-    for (const auto& symbol : symbols) {
-        custom_symbols[symbol.first.as<std::string>()] = symbol.second.as<uint32_t>();
-    }
+    if(elfPatch::loadSymbols(file_path, custom_symbols) != PatchError::NONE) LOG_ERR_AND_RETURN(TweakError::DATA_FILE_MISSING);
 
     return TweakError::NONE;
 }
 
 static TweakError Apply_Patch(const fspath& file_path) {
-    std::string file_data;
-    if (Utility::getFileContents(file_path, file_data, true)) LOG_ERR_AND_RETURN(TweakError::DATA_FILE_MISSING);
+    //compiled from the YAML diffs ahead of time by asm/compile_diffs.py, so applying one is just a few copies
+    elfPatch::Patch patch;
+    if(elfPatch::loadPatch(file_path, patch) != PatchError::NONE) LOG_ERR_AND_RETURN(TweakError::DATA_FILE_MISSING);
 
-    const YAML::Node patches = YAML::Load(file_data);
     RandoSession::CacheEntry& entry = g_session.openGameFile("code/cking.rpx@RPX@ELF");
+    entry.addAction<FileTypes::ELF>([patch = std::move(patch)](RandoSession* session, FileTypes::ELF& elf) -> int {
+        RPX_ERROR_CHECK(elfPatch::applyPatch(elf, patch));
 
-    if(!patches["Data"] && !patches["Relocations"]) return TweakError::PATCH_MISSING_KEY;
-
-    if(patches["Data"]) {
-        entry.addAction([patches](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
-            for (const auto& patch : patches["Data"]) {
-                const uint32_t offset = patch.first.as<uint32_t>();
-                offset_t sectionOffset = elfUtil::AddressToOffset(elf, offset);
-                if (!sectionOffset) { //address not in section
-                    std::string data;
-                    for (const uint8_t& byte : patch.second.as<std::vector<uint8_t>>()) {
-                        data += byte;
-                    }
-                    RPX_ERROR_CHECK(elf.extend_section(2, offset, data)); //add data at the specified offset
-                }
-                else {
-                    for (const uint8_t& byte : patch.second.as<std::vector<uint8_t>>()) {
-                        RPX_ERROR_CHECK(elfUtil::write_u8(elf, sectionOffset, byte));
-                        sectionOffset.offset++; //Cycles through the bytes individually, need to increase the offset by one each time
-                    }
-                }
-            }
-
-            return true;
-        });
-    }
-    
-    if(patches["Relocations"]) {
-        for (const auto& relocation : patches["Relocations"]) {
-            if(!relocation["r_offset"].IsScalar() || !relocation["r_info"].IsScalar() || !relocation["r_addend"].IsScalar()) {
-                LOG_ERR_AND_RETURN(TweakError::RELOCATION_MISSING_KEY);
-            }
-
-            Elf32_Rela reloc;
-            reloc.r_offset = relocation["r_offset"].as<uint32_t>();
-            reloc.r_info = relocation["r_info"].as<uint32_t>();
-            reloc.r_addend = relocation["r_addend"].as<uint32_t>();
-
-            entry.addAction([reloc](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
-
-                if(reloc.r_offset >= 0x10000000) {
-                    if(reloc.r_offset >= 0x1018C0C0) {   
-                        RPX_ERROR_CHECK(elfUtil::addRelocation(elf, 9, reloc)); //in the .data section, go in .rela.data
-                    }
-                    else {
-                        RPX_ERROR_CHECK(elfUtil::addRelocation(elf, 8, reloc)); //in the .rodata section, go in .rela.rodata
-                    }
-                }
-                else {
-                    RPX_ERROR_CHECK(elfUtil::addRelocation(elf, 7, reloc)); //in the .text section, go in .rela.text
-                }
-
-                return true;
-            });
-        }
-    }
+        return true;
+    });
 
     return TweakError::NONE;
 }
@@ -139,13 +80,14 @@ static TweakError Apply_Patch(const fspath& file_path) {
 
 TweakError set_new_game_starting_location(const uint8_t spawn_id, const uint8_t room_index) {
     RandoSession::CacheEntry& entry = g_session.openGameFile("code/cking.rpx@RPX@ELF");
-    entry.addAction([spawn_id, room_index](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    entry.addAction<FileTypes::ELF>([spawn_id, room_index](RandoSession* session, FileTypes::ELF& elf) -> int {
         
-        RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, 0x025B508F), room_index));
-        RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, 0x025B50CB), room_index));
-        RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, 0x025B5093), spawn_id));
-        RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, 0x025B50CF), spawn_id));
+        elfUtil::WriteBatch batch;
+        batch.write_u8(0x025B508F, room_index);
+        batch.write_u8(0x025B50CB, room_index);
+        batch.write_u8(0x025B5093, spawn_id);
+        batch.write_u8(0x025B50CF, spawn_id);
+        RPX_ERROR_CHECK(batch.apply(elf));
 
         return true;
     });
@@ -157,8 +99,7 @@ TweakError change_ship_starting_island(const uint8_t room_index) {
 
     RandoSession::CacheEntry& room = g_session.openGameFile(path);
     RandoSession::CacheEntry& stage = g_session.openGameFile("content/Common/Pack/first_szs_permanent.pack@SARC@sea_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@stage.dzs@DZX");
-    room.addAction([&stage](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(room_dzr, FileTypes::DZXFile, data)
+    room.addAction<FileTypes::DZXFile>([&stage](RandoSession* session, FileTypes::DZXFile& room_dzr) -> int {
         
         std::vector<ChunkEntry*> ship_spawns = room_dzr.entries_by_type("SHIP");
         ChunkEntry* ship_spawn_0 = nullptr;
@@ -167,8 +108,7 @@ TweakError change_ship_starting_island(const uint8_t room_index) {
         }
         if(ship_spawn_0 == nullptr) LOG_ERR_AND_RETURN_BOOL(TweakError::MISSING_ENTITY);
 
-        stage.addAction([ship_spawn_0 = *ship_spawn_0](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(stage_dzs, FileTypes::DZXFile, data)
+        stage.addAction<FileTypes::DZXFile>([ship_spawn_0 = *ship_spawn_0](RandoSession* session, FileTypes::DZXFile& stage_dzs) -> int {
 
             std::vector<ChunkEntry*> actors = stage_dzs.entries_by_type("ACTR");
             for (ChunkEntry* actor : actors) {
@@ -201,8 +141,7 @@ TweakError make_all_text_instant() {
 
         for (const auto& path : paths) {
             RandoSession::CacheEntry& entry = g_session.openGameFile(path);
-            entry.addAction([](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data);
+            entry.addAction<FileTypes::MSBTFile>([](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
 
                 for (auto& [label, message] : msbt.messages_by_label) {
                     std::u16string& String = message.text.message;
@@ -265,9 +204,9 @@ TweakError make_all_text_instant() {
 
 TweakError fix_deku_leaf_model() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/Omori_Room0.szs@YAZ0@SARC@Room0.bfres@BFRES@room.dzr");
-    entry.addAction([](RandoSession* session, FileType* data) -> int 
+    entry.addAction<RawFile>([](RandoSession* session, RawFile& generic) -> int 
     {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data) //do this on the stream so it happens before location mod
+        //do this on the stream so it happens before location mod
 
         FileTypes::DZXFile dzr;
         LOG_AND_RETURN_BOOL_IF_ERR(dzr.loadFromBinary(generic.data));
@@ -349,15 +288,13 @@ TweakError allow_all_items_to_be_field_items() {
             szs_name_pointer = szs_name_pointers.at(item_id_to_copy_from);
         }
 
-        rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
             RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, field_item_resources_addr), szs_name_pointer));
         
             return true;
         });
         if (item_resources_addr_to_fix) {
-            rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+            rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
                 RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, item_resources_addr_to_fix), szs_name_pointer));
             
                 return true;
@@ -375,8 +312,7 @@ TweakError allow_all_items_to_be_field_items() {
         }
         relocation.r_addend = szs_name_pointer - section_start; //needs offset into the .rodata section (.text for vscroll), subtract start address from data location
 
-        rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
             RPX_ERROR_CHECK(elfUtil::addRelocation(elf, 9, relocation));
 
             return true;
@@ -388,16 +324,14 @@ TweakError allow_all_items_to_be_field_items() {
             relocation2.r_info = relocation.r_info; //same as first entry
             relocation2.r_addend = relocation.r_addend; //same as first entry
 
-            rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+            rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
                 RPX_ERROR_CHECK(elfUtil::addRelocation(elf, 9, relocation2));
 
                 return true;
             });
         }
 
-        rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
             
             const std::vector<uint8_t> data1 = elfUtil::read_bytes(elf, elfUtil::AddressToOffset(elf, item_resources_addr_to_copy_from + 8), 0xD);
             const std::vector<uint8_t> data2 = elfUtil::read_bytes(elf, elfUtil::AddressToOffset(elf, item_resources_addr_to_copy_from + 0x1C), 4);
@@ -412,8 +346,7 @@ TweakError allow_all_items_to_be_field_items() {
         });
     }
 
-    rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
             
         for (const uint32_t& address : { 0x0255220CU, 0x02552214U, 0x0255221CU, 0x02552224U, 0x0255222CU, 0x02552234U, 0x02552450U }) { //unsigned to make compiler happy
             RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, address), 0x60000000));
@@ -423,14 +356,13 @@ TweakError allow_all_items_to_be_field_items() {
     });
 
     //execItemGet, mode_wait, and getYOffset had their switch cases optimized out, so their patches are a little more involved in HD
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/field_items_diff.yaml")); 
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/field_items_diff.bin")); 
     
     const uint32_t item_info_list_start = 0x101E8674;
     for (unsigned int item_id = 0x00; item_id < 0xFF + 1; item_id++) {
         const uint32_t item_info_entry_addr = item_info_list_start + 4 * item_id;
 
-        rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
             const uint8_t original_y_offset = elfUtil::read_u8(elf, elfUtil::AddressToOffset(elf, item_info_entry_addr + 1));
             if (original_y_offset == 0) {
@@ -457,8 +389,7 @@ TweakError remove_shop_item_forced_uniqueness_bit() {
     for (const uint8_t shop_item_index : { 0x0, 0xB, 0xC, 0xD }) {
         const uint32_t shop_item_data_addr = shop_item_data_list_start + shop_item_index * 0x10;
         
-        rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
             uint8_t buy_requirements_bitfield = elfUtil::read_u8(elf, elfUtil::AddressToOffset(elf, shop_item_data_addr + 0xC));
             buy_requirements_bitfield = (buy_requirements_bitfield & (~0x2));
@@ -474,8 +405,7 @@ TweakError remove_shop_item_forced_uniqueness_bit() {
 TweakError remove_ff2_cutscenes(const bool& randomize_boss_entrances) {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/M2tower_Room0.szs@YAZ0@SARC@Room0.bfres@BFRES@room.dzr@DZX");
 
-    entry.addAction([&](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    entry.addAction<FileTypes::DZXFile>([&](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
         
         std::vector<ChunkEntry*> spawns = dzr.entries_by_type("PLYR");
         for (ChunkEntry* spawn : spawns) {
@@ -502,13 +432,12 @@ TweakError remove_ff2_cutscenes(const bool& randomize_boss_entrances) {
 }
 
 TweakError make_items_progressive() {
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/make_items_progressive_diff.yaml"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/make_items_progressive_diff.bin"));
 
     const uint32_t item_get_func_pointer = 0x0001DA54; //First relevant relocation entry in .rela.data (overwrites .data section when loaded)
 
     RandoSession::CacheEntry& rpx = g_session.openGameFile("code/cking.rpx@RPX@ELF");
-    rpx.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data);
+    rpx.addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         for (const uint8_t sword_id : {0x38, 0x39, 0x3A, 0x3D, 0x3E}) {
             const uint32_t item_get_func_addr = item_get_func_pointer + (sword_id * 0xC) + 8;
@@ -547,18 +476,22 @@ TweakError make_items_progressive() {
             RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, item_get_func_addr, 9), custom_symbols.at("progressive_magic_meter_item_func") - 0x02000000));
         }
 
+        elfUtil::WriteBatch batch;
+
         //nop some code that sets max bombs and arrows to 30
         //This avoids downgrading bomb bags or quivers
-        RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x0254e8c4), 0x60000000));
-        RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x0254e8cc), 0x60000000));
-        RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x0254e66c), 0x60000000));
-        RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x0254e674), 0x60000000));
+        batch.write_u32(0x0254e8c4, 0x60000000);
+        batch.write_u32(0x0254e8cc, 0x60000000);
+        batch.write_u32(0x0254e66c, 0x60000000);
+        batch.write_u32(0x0254e674, 0x60000000);
 
         //Modify the deku leaf to skip giving you magic
         //Instead we make magic its own item that the player starts with by default
         //Allows other items to use magic before getting leaf
-        RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x0254e96c), 0x60000000));
-        RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x0254e97c), 0x60000000));
+        batch.write_u32(0x0254e96c, 0x60000000);
+        batch.write_u32(0x0254e97c, 0x60000000);
+
+        RPX_ERROR_CHECK(batch.apply(elf));
 
         return true;
     });
@@ -573,8 +506,7 @@ TweakError make_items_progressive() {
     for (const auto& language : Text::supported_languages) {
         RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@message_msbt.szs@YAZ0@SARC@message.msbt@MSBT");
     
-        entry.addAction([messages, language](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+        entry.addAction<FileTypes::MSBTFile>([messages, language](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
 
             const Message& to_copy = msbt.messages_by_label["00" + std::to_string(101 + 0xB2)];
             const std::u16string message = messages.at(language);
@@ -591,8 +523,7 @@ TweakError make_items_progressive() {
 TweakError add_ganons_tower_warp_to_ff2() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/szs_permanent1.pack@SARC@sea_Room1.szs@YAZ0@SARC@Room1.bfres@BFRES@room.dzr@DZX");
     
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         ChunkEntry& warp = dzr.add_entity("ACTR", 1);
         warp.data = "Warpmj\x00\x00\x00\x00\x00\x11\xc8\x93\x0f\xd9\x00\x00\x00\x00\xc8\x91\xf7\xfa\x00\x00\x00\x00\x00\x00\xff\xff"s;
@@ -605,8 +536,8 @@ TweakError add_ganons_tower_warp_to_ff2() {
 
 TweakError add_chest_in_place_medli_gift() {
     RandoSession::CacheEntry& stage = g_session.openGameFile("content/Common/Stage/M_Dra09_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@stage.dzs");
-    stage.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data) //do this on the stream so it happens before location mod
+    stage.addAction<RawFile>([](RandoSession* session, RawFile& generic) -> int {
+        //do this on the stream so it happens before location mod
 
         FileTypes::DZXFile dzs;
         LOG_AND_RETURN_BOOL_IF_ERR(dzs.loadFromBinary(generic.data));
@@ -620,8 +551,7 @@ TweakError add_chest_in_place_medli_gift() {
     });
 
     RandoSession::CacheEntry& dungeon = g_session.openGameFile("content/Common/Stage/M_NewD2_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@stage.dzs@DZX");
-    dungeon.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzs, FileTypes::DZXFile, data)
+    dungeon.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzs) -> int {
 
         ChunkEntry& dummyChest = dzs.add_entity("TRES");
         dummyChest.data = "takara3\x00\xFF\x20\x08\x80\xc4\xca\x99\xec\x46\x54\x80\x00\x43\x83\x84\x5a\x00\x09\xcc\x16\x0f\xff\xff\xff"s;
@@ -634,8 +564,8 @@ TweakError add_chest_in_place_medli_gift() {
 
 TweakError add_chest_in_place_queen_fairy_cutscene() {
     RandoSession::CacheEntry& room = g_session.openGameFile("content/Common/Pack/szs_permanent2.pack@SARC@sea_Room9.szs@YAZ0@SARC@Room9.bfres@BFRES@room.dzr");
-    room.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data) //do this on the stream so it happens before location mod
+    room.addAction<RawFile>([](RandoSession* session, RawFile& generic) -> int {
+        //do this on the stream so it happens before location mod
 
         FileTypes::DZXFile dzr;
         LOG_AND_RETURN_BOOL_IF_ERR(dzr.loadFromBinary(generic.data));
@@ -657,8 +587,7 @@ TweakError add_more_magic_jars() {
     //Same thing for arrows
     {
         RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/M_NewD2_Room2.szs@YAZ0@SARC@Room2.bfres@BFRES@room.dzr@DZX");
-        entry.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(drc_hub, FileTypes::DZXFile, data)
+        entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& drc_hub) -> int {
 
             std::vector<ChunkEntry*> actors = drc_hub.entries_by_type("ACTR");
             std::vector<ChunkEntry*> skulls;
@@ -678,8 +607,7 @@ TweakError add_more_magic_jars() {
 
     {
         RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/M_NewD2_Room10.szs@YAZ0@SARC@Room10.bfres@BFRES@room.dzr@DZX");
-        entry.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(drc_before_boss, FileTypes::DZXFile, data)
+        entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& drc_before_boss) -> int {
 
             std::vector<ChunkEntry*> actors = drc_before_boss.entries_by_type("ACTR");
             std::vector<ChunkEntry*> skulls;
@@ -700,8 +628,7 @@ TweakError add_more_magic_jars() {
     //Add grass that will always drop some on each of the islands
     {
         RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/szs_permanent1.pack@SARC@sea_Room13.szs@YAZ0@SARC@Room13.bfres@BFRES@room.dzr@DZX");
-        entry.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(dri, FileTypes::DZXFile, data)
+        entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dri) -> int {
 
             ChunkEntry& grass1 = dri.add_entity("ACTR");
             grass1.data = "kusax1\x00\x00\x00\x00\x0E\x00\x48\x4C\xC7\x80\x44\xED\x80\x00\xC8\x45\xB7\xC0\x00\x00\x00\x00\x00\x00\xFF\xFF"s; //62.50% chance of small magic, 37.50% chance of large magic
@@ -715,8 +642,7 @@ TweakError add_more_magic_jars() {
     //Add magic to one of the pots outside the TotG miniboss
     {
         RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/Siren_Room14.szs@YAZ0@SARC@Room14.bfres@BFRES@room.dzr@DZX");
-        entry.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(totg, FileTypes::DZXFile, data)
+        entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& totg) -> int {
 
             std::vector<ChunkEntry*> actors = totg.entries_by_type("ACTR");
             std::vector<ChunkEntry*> pots;
@@ -739,8 +665,7 @@ TweakError modify_title_screen() {
     using namespace NintendoWare::Layout;
 
     RandoSession::CacheEntry& lytEntry = g_session.openGameFile("content/Common/Layout/Title_00.szs@YAZ0@SARC@blyt/Title_00.bflyt@BFLYT");
-    lytEntry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(layout, FileTypes::FLYTFile, data)
+    lytEntry.addAction<FileTypes::FLYTFile>([](RandoSession* session, FileTypes::FLYTFile& layout) -> int {
         
         //add version number
         Pane& newPane = layout.rootPane.children[0].children[1].children[3].duplicateChildPane(1); //unused version number text
@@ -768,42 +693,40 @@ TweakError modify_title_screen() {
 
     //update "The Legend of Zelda" texture
     RandoSession::CacheEntry& tEntry = g_session.openGameFile("content/Common/Layout/Title_00.szs@YAZ0@SARC@timg/TitleLogoZelda_00^l.bflim@BFLIM");
-    tEntry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(title, FileTypes::FLIMFile, data)
+    tEntry.addAction<FileTypes::FLIMFile>([](RandoSession* session, FileTypes::FLIMFile& title) -> int {
         
-        FILETYPE_ERROR_CHECK(title.replaceWithDDS(Utility::get_data_path() / "assets/Title.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, true));
+        FILETYPE_ERROR_CHECK(title.replaceWithDDS(Utility::get_data_path() / "assets/Title.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, true, session->getWorkerPool()));
 
         return true;
     });
 
     //update "The Wind Waker" texture
     RandoSession::CacheEntry& sEntry = g_session.openGameFile("content/Common/Layout/Title_00.szs@YAZ0@SARC@timg/TitleLogoWindwaker_00^l.bflim@BFLIM");
-    sEntry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(subtitle, FileTypes::FLIMFile, data)
+    sEntry.addAction<FileTypes::FLIMFile>([](RandoSession* session, FileTypes::FLIMFile& subtitle) -> int {
         
-        FILETYPE_ERROR_CHECK(subtitle.replaceWithDDS(Utility::get_data_path() / "assets/Subtitle.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, true));
+        FILETYPE_ERROR_CHECK(subtitle.replaceWithDDS(Utility::get_data_path() / "assets/Subtitle.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, true, session->getWorkerPool()));
 
         return true;
     });
 
     //update mask for "The Wind Waker" texture
     RandoSession::CacheEntry& mEntry = g_session.openGameFile("content/Common/Layout/Title_00.szs@YAZ0@SARC@timg/TitleLogoWindwakerMask_00^s.bflim@BFLIM");
-    mEntry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(mask, FileTypes::FLIMFile, data)
+    mEntry.addAction<FileTypes::FLIMFile>([](RandoSession* session, FileTypes::FLIMFile& mask) -> int {
         
-        FILETYPE_ERROR_CHECK(mask.replaceWithDDS(Utility::get_data_path() / "assets/SubtitleMask.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, false));
+        FILETYPE_ERROR_CHECK(mask.replaceWithDDS(Utility::get_data_path() / "assets/SubtitleMask.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, false, session->getWorkerPool()));
 
         return true;
     });
 
     //update sparkle size/position
     RandoSession::CacheEntry& rpx = g_session.openGameFile("code/cking.rpx@RPX@ELF");
-    rpx.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    rpx.addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
 
-        RPX_ERROR_CHECK(elfUtil::write_float(elf, elfUtil::AddressToOffset(elf, 0x101F7048), 1.4f)); //scale
-        RPX_ERROR_CHECK(elfUtil::write_float(elf, elfUtil::AddressToOffset(elf, 0x101F7044), 2.25f)); //possibly particle size, JP changes it for its larger title text
-        RPX_ERROR_CHECK(elfUtil::write_float(elf, elfUtil::AddressToOffset(elf, 0x10108280), -38.0f)); //vertical position
+        elfUtil::WriteBatch batch;
+        batch.write_float(0x101F7048, 1.4f); //scale
+        batch.write_float(0x101F7044, 2.25f); //possibly particle size, JP changes it for its larger title text
+        batch.write_float(0x10108280, -38.0f); //vertical position
+        RPX_ERROR_CHECK(batch.apply(elf));
 
         return true;
     });
@@ -815,12 +738,11 @@ TweakError update_name_and_icon() {
     if(!g_session.copyToGameFile(Utility::get_data_path() / "assets/iconTex.tga", "meta/iconTex.tga", /*resourceFile = */ true)) LOG_ERR_AND_RETURN(TweakError::FILE_COPY_FAILED);
 
     RandoSession::CacheEntry& metaEntry = g_session.openGameFile("meta/meta.xml");
-    metaEntry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data)\
-        std::stringstream& metaStream = generic.data;
+    metaEntry.addAction<RawFile>([](RandoSession* session, RawFile& generic) -> int {
+        Utility::ByteStream& metaStream = generic.data;
 
         tinyxml2::XMLDocument meta;
-        meta.Parse(metaStream.str().c_str(), metaStream.str().size());
+        meta.Parse(metaStream.data(), metaStream.size());
 
         tinyxml2::XMLElement* metaRoot = meta.RootElement();
         metaRoot->FirstChildElement("longname_en")->SetText("THE LEGEND OF ZELDA\nThe Wind Waker HD Randomizer");
@@ -838,24 +760,23 @@ TweakError update_name_and_icon() {
         
         tinyxml2::XMLPrinter printer;
         meta.Print(&printer);
-        metaStream.str(printer.CStr());
+        metaStream.assign(std::string_view(printer.CStr()));
 
         return true;
     });
     
     RandoSession::CacheEntry& appEntry = g_session.openGameFile("code/app.xml");
-    appEntry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data)\
-        std::stringstream& appStream = generic.data;
+    appEntry.addAction<RawFile>([](RandoSession* session, RawFile& generic) -> int {
+        Utility::ByteStream& appStream = generic.data;
 
         tinyxml2::XMLDocument app;
-        app.Parse(appStream.str().c_str(), appStream.str().size());
+        app.Parse(appStream.data(), appStream.size());
         tinyxml2::XMLElement* appRoot = app.RootElement();
         appRoot->FirstChildElement("title_id")->SetText("0005000010143599");
         
         tinyxml2::XMLPrinter printer;
         app.Print(&printer);
-        appStream.str(printer.CStr());
+        appStream.assign(std::string_view(printer.CStr()));
 
         return true;
     });
@@ -961,8 +882,7 @@ TweakError allow_dungeon_items_to_appear_anywhere(World& world) {
         const uint8_t base_item_id = item_name_to_id.at(item_data.base_item_name);
         const std::string dungeon_name = dungeon_names.at(item_data.short_name);
 
-        rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
             RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, item_get_func_pointer + (0xC * item_id) + 0x8, 9), custom_symbols.at(itemToFunc.at(item_data.item_value)) - 0x02000000)); //write to the relocation entries
 
@@ -974,8 +894,7 @@ TweakError allow_dungeon_items_to_appear_anywhere(World& world) {
 
         for (const auto& language : Text::supported_languages) {
             RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@message_msbt.szs@YAZ0@SARC@message.msbt@MSBT");
-            entry.addAction([=](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+            entry.addAction<FileTypes::MSBTFile>([=](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
 
                 const uint32_t message_id = 101 + item_id;
                 const Message& to_copy = msbt.messages_by_label["00" + std::to_string(101 + base_item_id)];
@@ -996,8 +915,7 @@ TweakError allow_dungeon_items_to_appear_anywhere(World& world) {
 
         const uint32_t szs_name_pointer = szs_name_pointers.at(base_item_id);
 
-        rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
             RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, field_item_resources_addr), szs_name_pointer));
             RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, item_resources_addr), szs_name_pointer));
@@ -1028,8 +946,7 @@ TweakError allow_dungeon_items_to_appear_anywhere(World& world) {
 
         const uint32_t item_info_entry_addr = item_info_list_start + item_id * 4;
 
-        rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
             RPX_ERROR_CHECK(elfUtil::addRelocation(elf, 9, relocation));
             RPX_ERROR_CHECK(elfUtil::addRelocation(elf, 9, relocation2));
@@ -1068,8 +985,7 @@ TweakError remove_bog_warp_in_cs() {
     for (uint8_t i = 1; i < 49+1; i++) {
         const fspath path = getRoomDzrPath("sea", i);
         RandoSession::CacheEntry& entry = g_session.openGameFile(path);
-        entry.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(room_dzr, FileTypes::DZXFile, data)
+        entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& room_dzr) -> int {
 
             for (ChunkEntry* spawn : room_dzr.entries_by_type("PLYR")) {
                 uint8_t spawn_type = ((*reinterpret_cast<uint8_t*>(&spawn->data[0xB]) & 0xF0) >> 4);
@@ -1092,8 +1008,7 @@ TweakError fix_shop_item_y_offsets() {
 
     for (unsigned int id = 0; id < 0xFF + 1; id++) {
         const uint32_t display_data_addr = shop_item_display_data_list_start + id * 0x20;
-        rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
             const float y_offset = elfUtil::read_float(elf, elfUtil::AddressToOffset(elf, display_data_addr + 0x10));
 
             if (y_offset == 0.0f && ArrowID.count(id) == 0) {
@@ -1131,8 +1046,7 @@ TweakError update_text_replacements(World& world) {
 
             fspath filePath = std::string("content/Common/Pack/permanent_2d_Us") + language + ".pack@SARC@message" + messageNum + "_msbt.szs@YAZ0@SARC@message" + messageNum + ".msbt@MSBT";
             RandoSession::CacheEntry& entry = g_session.openGameFile(filePath);
-            entry.addAction([language, messageLabel = messageLabel, languages = languages](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+            entry.addAction<FileTypes::MSBTFile>([language, messageLabel = messageLabel, languages = languages](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
 
                 msbt.messages_by_label[messageLabel].text.message = languages.at(language);
 
@@ -1147,8 +1061,7 @@ TweakError update_text_replacements(World& world) {
 TweakError shorten_zephos_event() {
     RandoSession::CacheEntry& list = g_session.openGameFile("content/Common/Pack/first_szs_permanent.pack@SARC@sea_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@event_list.dat@EVENTS");
 
-    list.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(event_list, FileTypes::EventList, data)
+    list.addAction<FileTypes::EventList>([](RandoSession* session, FileTypes::EventList& event_list) -> int {
         
         if(event_list.Events_By_Name.count("TACT_HT") == 0) LOG_ERR_AND_RETURN_BOOL(TweakError::MISSING_EVENT);
         std::shared_ptr<Event> wind_shrine_event = event_list.Events_By_Name.at("TACT_HT");
@@ -1215,8 +1128,7 @@ TweakError update_korl_dialog(World& world) {
 
             if(custom_symbols.count("last_korl_hint_message_number") == 0) LOG_ERR_AND_RETURN(TweakError::MISSING_SYMBOL);
             const uint32_t num_messages_address = custom_symbols.at("last_korl_hint_message_number");
-            g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([num_messages_address, numExtra = hintMessages.size() - 1](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+            g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([num_messages_address, numExtra = hintMessages.size() - 1](RandoSession* session, FileTypes::ELF& elf) -> int {
 
                 RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, num_messages_address), 3443 + numExtra));
 
@@ -1226,8 +1138,7 @@ TweakError update_korl_dialog(World& world) {
             for (uint32_t x = 0; x < hintMessages.size(); x++) {
                 const std::u16string msg = hintMessages[x];
                 const std::string label = "0"s + std::to_string(3443 + x);
-                entry.addAction([label, msg](RandoSession* session, FileType* data) -> int {
-                    CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+                entry.addAction<FileTypes::MSBTFile>([label, msg](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
 
                     msbt.messages_by_label[label].text.message = msg;
 
@@ -1250,7 +1161,7 @@ TweakError update_ho_ho_dialog(World& world) {
     for (const auto& language : Text::supported_languages) {
         RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@message4_msbt.szs@YAZ0@SARC@message4.msbt@MSBT");
         
-        entry.addAction([=, &world](RandoSession* session, FileType* data) -> int {
+        entry.addAction<FileTypes::MSBTFile>([=, &world](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
             for (auto& [hohoLocation, hintLocations] : world.hohoHints) {
                 std::u16string hintLines = u"";
                 size_t i = 0; // counter to know when to add null terminator
@@ -1268,7 +1179,6 @@ TweakError update_ho_ho_dialog(World& world) {
                     hint = Text::pad_str_4_lines(hint);
                     hintLines += hint;
                 }
-                CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
 
                 msbt.messages_by_label[hohoLocation->messageLabel].text.message = hintLines;
             }
@@ -1312,9 +1222,8 @@ TweakError rotate_ho_ho_to_face_hints(World& world) {
             const fspath filepath = getRoomDzrPath("sea", hohoIslandNum);
             RandoSession::CacheEntry& room = g_session.openGameFile(filepath);
 
-            room.addAction([=](RandoSession* session, FileType* data) -> int {
+            room.addAction<FileTypes::DZXFile>([=](RandoSession* session, FileTypes::DZXFile& islandDzr) -> int {
 
-                CAST_ENTRY_TO_FILETYPE(islandDzr, FileTypes::DZXFile, data)
                 auto actors = islandDzr.entries_by_type("ACTR");
 
                 // For each ho ho actor (actor name "Ah"), rotate him to face the destSectorMult
@@ -1357,8 +1266,7 @@ TweakError set_starting_health(const uint16_t heartPieces, const uint16_t heartC
     const uint16_t starting_health = (heartContainers * 4) + heartPieces;
     const uint32_t starting_quarter_hearts_address = custom_symbols.at("starting_quarter_hearts");
 
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([starting_quarter_hearts_address, starting_health](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([starting_quarter_hearts_address, starting_health](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         RPX_ERROR_CHECK(elfUtil::write_u16(elf, elfUtil::AddressToOffset(elf, starting_quarter_hearts_address), starting_health));
 
@@ -1366,7 +1274,7 @@ TweakError set_starting_health(const uint16_t heartPieces, const uint16_t heartC
     });
 
     if(starting_health < 8) {
-        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/remove_low_health_effects_diff.yaml")); 
+        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/remove_low_health_effects_diff.bin")); 
     }
 
     return TweakError::NONE;
@@ -1375,8 +1283,7 @@ TweakError set_starting_health(const uint16_t heartPieces, const uint16_t heartC
 TweakError set_starting_magic(const uint8_t& startingMagic) {
     if(custom_symbols.count("starting_magic") == 0) LOG_ERR_AND_RETURN(TweakError::MISSING_SYMBOL);
     const uint32_t starting_magic_address = custom_symbols.at("starting_magic");
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([starting_magic_address, startingMagic](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([starting_magic_address, startingMagic](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, starting_magic_address), startingMagic));
 
@@ -1389,8 +1296,7 @@ TweakError set_starting_magic(const uint8_t& startingMagic) {
 TweakError set_damage_multiplier(const float& multiplier) {
     if(custom_symbols.count("custom_damage_multiplier") == 0) LOG_ERR_AND_RETURN(TweakError::MISSING_SYMBOL);
     const uint32_t damage_multiplier_address = custom_symbols.at("custom_damage_multiplier");
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([damage_multiplier_address, multiplier](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([damage_multiplier_address, multiplier](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         RPX_ERROR_CHECK(elfUtil::write_float(elf, elfUtil::AddressToOffset(elf, damage_multiplier_address), multiplier));
         
@@ -1401,8 +1307,7 @@ TweakError set_damage_multiplier(const float& multiplier) {
     if(multiplier != 2.0f) {
         for (const auto& language : Text::supported_languages) {
             RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@SequenceWindow_00_msbt.szs@YAZ0@SARC@SequenceWindow_00.msbt@MSBT");
-            entry.addAction([=](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+            entry.addAction<FileTypes::MSBTFile>([=](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
 
                 static const std::unordered_map<std::string, std::u16string> word_to_replace = {
                     {"English", u"double"s},
@@ -1426,8 +1331,7 @@ TweakError set_damage_multiplier(const float& multiplier) {
 TweakError set_pig_color(const PigColor& color) {
     if(custom_symbols.count("outset_pig_color") == 0) LOG_ERR_AND_RETURN(TweakError::MISSING_SYMBOL);
     const uint32_t pig_color_address = custom_symbols.at("outset_pig_color");
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([pig_color_address, color](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([pig_color_address, color](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, pig_color_address), static_cast<uint8_t>(color)));
 
@@ -1439,8 +1343,7 @@ TweakError set_pig_color(const PigColor& color) {
 
 TweakError add_pirate_ship_to_windfall() {
     RandoSession::CacheEntry& windfall = g_session.openGameFile("content/Common/Pack/szs_permanent1.pack@SARC@sea_Room11.szs@YAZ0@SARC@Room11.bfres@BFRES@room.dzr@DZX");
-    windfall.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(windfallDzr, FileTypes::DZXFile, data)
+    windfall.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& windfallDzr) -> int {
 
         std::vector<ChunkEntry*> wf_layer_2_actors = windfallDzr.entries_by_type_and_layer("ACTR", 2);
         std::string layer_2_ship_data; //copy actor data, add_entity reallocates vector and invalidates pointer
@@ -1457,8 +1360,7 @@ TweakError add_pirate_ship_to_windfall() {
     });
 
     RandoSession::CacheEntry& shipRoom = g_session.openGameFile("content/Common/Stage/Asoko_Room0.szs@YAZ0@SARC@Room0.bfres@BFRES@room.dzr@DZX");
-    shipRoom.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(shipDzr, FileTypes::DZXFile, data)
+    shipRoom.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& shipDzr) -> int {
 
         for (const int layer_num : {2, 3}) {
             std::vector<ChunkEntry*> actors = shipDzr.entries_by_type_and_layer("ACTR", layer_num);
@@ -1501,8 +1403,7 @@ TweakError add_pirate_ship_to_windfall() {
     
     for (const auto& language : Text::supported_languages) {
         RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@message_msbt.szs@YAZ0@SARC@message.msbt@MSBT");
-        entry.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+        entry.addAction<FileTypes::MSBTFile>([](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
             msbt.messages_by_label["03008"].attributes.soundEffect = 106;
 
             Attributes attributes;
@@ -1522,8 +1423,7 @@ TweakError add_pirate_ship_to_windfall() {
 
     // Add a custom event where Aryll notices if the player got trapped in the chest room after the timer ran out and opens the door for them.
     RandoSession::CacheEntry& shipEventList = g_session.openGameFile("content/Common/Stage/Asoko_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@event_list.dat@EVENTS");
-    shipEventList.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(event_list, FileTypes::EventList, data)
+    shipEventList.addAction<FileTypes::EventList>([](RandoSession* session, FileTypes::EventList& event_list) -> int {
 
         Event& event = event_list.add_event("AryllOpensDoor");
         
@@ -1561,16 +1461,14 @@ TweakError add_pirate_ship_to_windfall() {
 
         return true;
     });
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([=](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, 0x101BFFC4), 5));
 
         return true;
     });
     RandoSession::CacheEntry& shipStage = g_session.openGameFile("content/Common/Stage/Asoko_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@stage.dzs@DZX");
-    shipStage.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(shipDzs, FileTypes::DZXFile, data)
+    shipStage.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& shipDzs) -> int {
 
         ChunkEntry& new_evnt = shipDzs.add_entity("EVNT");
         new_evnt.data = "\xFF" "AryllOpensDoor\x00\xFF\xFF\x00\xFF\xFF\xFF\xFF\xFF"s;
@@ -1620,8 +1518,7 @@ TweakError add_cross_dungeon_warps() {
             const float pos_z = Utility::Endian::toPlatform(eType::Big, warp.z);
             const uint16_t y_rot = Utility::Endian::toPlatform(eType::Big, warp.y_rot);
 
-            dzx_for_spawn->addAction([warp, pos_x, pos_y, pos_z, y_rot](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(dzx, FileTypes::DZXFile, data)
+            dzx_for_spawn->addAction<FileTypes::DZXFile>([warp, pos_x, pos_y, pos_z, y_rot](RandoSession* session, FileTypes::DZXFile& dzx) -> int {
 
                 ChunkEntry& spawn = dzx.add_entity("PLYR");
                 spawn.data = "Link\x00\x00\x00\x00\xFF\xFF\x70"s;
@@ -1644,8 +1541,7 @@ TweakError add_cross_dungeon_warps() {
                 return true;
             });
 
-            room.addAction([loop, warp, warp_index, pos_x, pos_y, pos_z, y_rot](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(room, FileTypes::DZXFile, data)
+            room.addAction<FileTypes::DZXFile>([loop, warp, warp_index, pos_x, pos_y, pos_z, y_rot](RandoSession* session, FileTypes::DZXFile& room) -> int {
 
                 std::vector<uint8_t> pot_index_to_exit;
                 for (const CyclicWarpPotData& other_warp : loop) {
@@ -1690,21 +1586,18 @@ TweakError add_cross_dungeon_warps() {
     RandoSession::CacheEntry& totg = g_session.openGameFile("content/Common/Particle/Particle.szs@YAZ0@SARC@Particle.bfres@BFRES@Pscene050.jpc@JPC");
     RandoSession::CacheEntry& ff = g_session.openGameFile("content/Common/Particle/Particle.szs@YAZ0@SARC@Particle.bfres@BFRES@Pscene043.jpc@JPC");
 
-    drc.addAction([&totg, &ff](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(drc, FileTypes::JPC, data)
+    drc.addAction<FileTypes::JPC>([&totg, &ff](RandoSession* session, FileTypes::JPC& drc) -> int {
 
         for (const uint16_t particle_id : {0x8161, 0x8162, 0x8165, 0x8166, 0x8112}) {
             const Particle& particle = drc.particles[drc.particle_index_by_id[particle_id]];
 
-            totg.addAction([particle](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(totg, FileTypes::JPC, data)
+            totg.addAction<FileTypes::JPC>([particle](RandoSession* session, FileTypes::JPC& totg) -> int {
 
                 FILETYPE_ERROR_CHECK(totg.addParticle(particle));
 
                 return true;
             });
-            ff.addAction([particle](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(ff, FileTypes::JPC, data)
+            ff.addAction<FileTypes::JPC>([particle](RandoSession* session, FileTypes::JPC& ff) -> int {
 
                 FILETYPE_ERROR_CHECK(ff.addParticle(particle));
 
@@ -1712,8 +1605,7 @@ TweakError add_cross_dungeon_warps() {
             });
 
             for (const std::string& textureFilename : particle.texDatabase.value().texFilenames) {
-                totg.addAction([textureFilename](RandoSession* session, FileType* data) -> int {
-                    CAST_ENTRY_TO_FILETYPE(totg, FileTypes::JPC, data)
+                totg.addAction<FileTypes::JPC>([textureFilename](RandoSession* session, FileTypes::JPC& totg) -> int {
 
                     if (totg.textures.find(textureFilename) == totg.textures.end()) {
                         FILETYPE_ERROR_CHECK(totg.addTexture(textureFilename));
@@ -1722,8 +1614,7 @@ TweakError add_cross_dungeon_warps() {
                     return true;
                 });
             
-                ff.addAction([textureFilename](RandoSession* session, FileType* data) -> int {
-                    CAST_ENTRY_TO_FILETYPE(ff, FileTypes::JPC, data)
+                ff.addAction<FileTypes::JPC>([textureFilename](RandoSession* session, FileTypes::JPC& ff) -> int {
 
                     if (ff.textures.find(textureFilename) == ff.textures.end()) {
                         FILETYPE_ERROR_CHECK(ff.addTexture(textureFilename));
@@ -1792,8 +1683,7 @@ TweakError add_boss_door_return_spawns() {
         Utility::Endian::toPlatform_inplace(eType::Big, newSpawn.z);
         Utility::Endian::toPlatform_inplace(eType::Big, newSpawn.y_rot);
 
-        dzx_for_spawn->addAction([newSpawn](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(dzx, FileTypes::DZXFile, data)
+        dzx_for_spawn->addAction<FileTypes::DZXFile>([newSpawn](RandoSession* session, FileTypes::DZXFile& dzx) -> int {
 
             ChunkEntry& spawn = dzx.add_entity("PLYR");
             spawn.data = "Link\x00\x00\x00\x00\xFF\xFF\x60"s;
@@ -1828,8 +1718,7 @@ TweakError add_boss_door_return_spawns() {
 
 TweakError remove_makar_kidnapping() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/kaze_Room3.szs@YAZ0@SARC@Room3.bfres@BFRES@room.dzr@DZX");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         std::vector<ChunkEntry*> actors = dzr.entries_by_type("ACTR");
 
@@ -1855,8 +1744,7 @@ TweakError remove_makar_kidnapping() {
 TweakError increase_crawl_speed() {
     //The 3.0 float crawling uses is shared with other things in HD, can't change it directly
     //Redirect both instances to load 6.0 from elsewhere
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
         
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x0014EC04, 7), 0x000355C4)); //update .rela.text entry
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x0014EC4C, 7), 0x000355C4)); //update .rela.text entry
@@ -1888,8 +1776,7 @@ TweakError add_chart_number_to_item_get_messages(World& world) {
             const std::u16string u16itemName = world.getItem(itemName).getUTF16Name(language, Text::Type::PRETTY);
 
             // The message between the "You obtained " and the next '!' will be replaced
-            entry.addAction([=](RandoSession* session, FileType* data) -> int {
-                CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+            entry.addAction<FileTypes::MSBTFile>([=](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
                 
                 auto& message = msbt.messages_by_label["00" + std::to_string(101 + item_id)].text.message;
                 auto replacementLength = message.find('!') - replacementIndex;
@@ -1905,8 +1792,7 @@ TweakError add_chart_number_to_item_get_messages(World& world) {
 }
 
 TweakError increase_grapple_animation_speed() {
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
         
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x02170250), 0x394B000A));
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x00075170, 7), 0x00010FFC)); //update .rela.text entry
@@ -1920,8 +1806,7 @@ TweakError increase_grapple_animation_speed() {
 }
 
 TweakError increase_block_move_animation() {
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
         
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x00153b00, 7), 0x00035AAC)); //update .rela.text entries
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x00153b48, 7), 0x00035AAC));
@@ -1941,8 +1826,7 @@ TweakError increase_block_move_animation() {
 
 TweakError increase_misc_animations() {
     //Float is shared, redirect it to read another float with the right value
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
         
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x00148820, 7), 0x000358D8));
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x001482a4, 7), 0x00035124));
@@ -1961,8 +1845,7 @@ TweakError increase_misc_animations() {
 TweakError set_casual_clothes() {
     if(custom_symbols.count("should_start_with_heros_clothes") == 0) LOG_ERR_AND_RETURN(TweakError::MISSING_SYMBOL);
     const uint32_t starting_clothes_addr = custom_symbols.at("should_start_with_heros_clothes");
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([=](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
         
         RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, starting_clothes_addr), 0));
     
@@ -1973,8 +1856,7 @@ TweakError set_casual_clothes() {
 }
 
 TweakError hide_ship_sail() {
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
         
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x02162B04), 0x4E800020));
 
@@ -1986,8 +1868,7 @@ TweakError hide_ship_sail() {
 
 TweakError shorten_auction_intro_event() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/Orichh_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@event_list.dat@EVENTS");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(event_list, FileTypes::EventList, data)
+    entry.addAction<FileTypes::EventList>([](RandoSession* session, FileTypes::EventList& event_list) -> int {
 
         if(event_list.Events_By_Name.count("AUCTION_START") == 0) LOG_ERR_AND_RETURN_BOOL(TweakError::MISSING_EVENT);
         std::shared_ptr<Event> auction_start_event = event_list.Events_By_Name.at("AUCTION_START");
@@ -2006,8 +1887,7 @@ TweakError shorten_auction_intro_event() {
 
 TweakError disable_invisible_walls() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/M_NewD2_Room2.szs@YAZ0@SARC@Room2.bfres@BFRES@room.dzr@DZX");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
         std::vector<ChunkEntry*> scobs = dzr.entries_by_type("SCOB");
 
         for (ChunkEntry* scob : scobs) {
@@ -2027,8 +1907,7 @@ TweakError update_skip_rematch_bosses_game_variable(const bool& skipRefights) {
     const uint32_t skip_rematch_bosses_addr = custom_symbols.at("skip_rematch_bosses");
 
     RandoSession::CacheEntry& entry = g_session.openGameFile("code/cking.rpx@RPX@ELF");
-    entry.addAction([=](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    entry.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         if (skipRefights) {
             RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, skip_rematch_bosses_addr), 0x01));
@@ -2048,8 +1927,7 @@ TweakError update_sword_mode_game_variable(const bool& remove_swords) {
     const uint32_t swordless_addr = custom_symbols.at("swordless");
 
     RandoSession::CacheEntry& entry = g_session.openGameFile("code/cking.rpx@RPX@ELF");
-    entry.addAction([=](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    entry.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         if (remove_swords) {
             RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, swordless_addr), 0x01));
@@ -2082,15 +1960,16 @@ TweakError update_starting_gear(const std::vector<GameItem>& startingItems) {
     if(custom_symbols.count("starting_gear") == 0) LOG_ERR_AND_RETURN(TweakError::MISSING_SYMBOL);
     const uint32_t starting_gear_array_addr = custom_symbols.at("starting_gear");
 
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([=](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
+        elfUtil::WriteBatch batch;
         for (size_t i = 0; i < startingGear.size(); i++) {
             const uint8_t item_id = static_cast<std::underlying_type_t<GameItem>>(startingGear[i]);
-            RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, starting_gear_array_addr + i), item_id));
+            batch.write_u8(starting_gear_array_addr + i, item_id);
         }
 
-        RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, starting_gear_array_addr + startingGear.size()), 0xFF));
+        batch.write_u8(starting_gear_array_addr + startingGear.size(), 0xFF);
+        RPX_ERROR_CHECK(batch.apply(elf));
 
         return true;
     });
@@ -2102,8 +1981,7 @@ TweakError add_hint_signs() {
     for (const auto& language : Text::supported_languages) {
         RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@message_msbt.szs@YAZ0@SARC@message.msbt@MSBT");
     
-        entry.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+        entry.addAction<FileTypes::MSBTFile>([](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
 
             const std::string new_message_label = "00847";
             Attributes attributes;
@@ -2122,8 +2000,7 @@ TweakError add_hint_signs() {
     }
 
     RandoSession::CacheEntry& room = g_session.openGameFile("content/Common/Stage/M_NewD2_Room2.szs@YAZ0@SARC@Room2.bfres@BFRES@room.dzr@DZX");
-    room.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    room.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         std::vector<ChunkEntry*> actors = dzr.entries_by_type("ACTR");
 
@@ -2144,8 +2021,7 @@ TweakError prevent_reverse_door_softlocks() {
     // Add switch triggers to remove boulders blocking DRC doors
     RandoSession::CacheEntry& drc_room13 = g_session.openGameFile("content/Common/Stage/M_NewD2_Room13.szs@YAZ0@SARC@Room13.bfres@BFRES@room.dzr@DZX");
 
-    drc_room13.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(drc_room13, FileTypes::DZXFile, data)
+    drc_room13.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& drc_room13) -> int {
 
         ChunkEntry& swc00_13 = drc_room13.add_entity("SCOB");
         swc00_13.data = "SW_C00\x00\x00\x00\x03\xFF\x05\x45\x24\xB0\x00\x00\x00\x00\x00\x43\x63\x00\x00\x00\x00\xC0\x00\xFF\xFF\xFF\xFF\x20\x10\x10\xFF"s;
@@ -2155,8 +2031,7 @@ TweakError prevent_reverse_door_softlocks() {
 
     RandoSession::CacheEntry& drc_room14 = g_session.openGameFile("content/Common/Stage/M_NewD2_Room14.szs@YAZ0@SARC@Room14.bfres@BFRES@room.dzr@DZX");
     
-    drc_room14.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(drc_room14, FileTypes::DZXFile, data)
+    drc_room14.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& drc_room14) -> int {
 
         ChunkEntry& swc00_14 = drc_room14.add_entity("SCOB");
         swc00_14.data = "SW_C00\x00\x00\x00\x03\xFF\x06\xC5\x7A\x20\x00\x44\xF3\xC0\x00\xC5\x06\xC0\x00\x00\x00\xA0\x00\xFF\xFF\xFF\xFF\x20\x10\x10\xFF"s;
@@ -2168,8 +2043,7 @@ TweakError prevent_reverse_door_softlocks() {
     // 1st song stone
     RandoSession::CacheEntry& et_room10 = g_session.openGameFile("content/Common/Stage/M_Dai_Room10.szs@YAZ0@SARC@Room10.bfres@BFRES@room.dzr@DZX");
 
-    et_room10.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(et_room10, FileTypes::DZXFile, data)
+    et_room10.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& et_room10) -> int {
 
         ChunkEntry& swc00_10 = et_room10.add_entity("SCOB");
         swc00_10.data = "SW_C00\x00\x00\x00\x03\xFF\x45\x45\x9F\x05\x90\xC4\xA2\x80\x00\x45\x98\x15\xF3\x00\x00\x00\x00\x00\x00\xFF\xFF\x1E\x14\x0A\xFF"s;
@@ -2180,8 +2054,7 @@ TweakError prevent_reverse_door_softlocks() {
     // Elephant statue 
     RandoSession::CacheEntry& et_room14 = g_session.openGameFile("content/Common/Stage/M_Dai_Room14.szs@YAZ0@SARC@Room14.bfres@BFRES@room.dzr@DZX");
 
-    et_room14.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(et_room14, FileTypes::DZXFile, data)
+    et_room14.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& et_room14) -> int {
 
         ChunkEntry& swc00_14 = et_room14.add_entity("SCOB");
         swc00_14.data = "SW_C00\x00\x00\x00\x03\xFF\x52\x45\x54\x80\x00\xC4\x96\x00\x00\x46\x16\x00\x00\x00\x00\x00\x00\x00\x00\xFF\xFF\x1E\x14\x0A\xFF"s;
@@ -2192,8 +2065,7 @@ TweakError prevent_reverse_door_softlocks() {
     // 2nd song stone
     RandoSession::CacheEntry& et_room15 = g_session.openGameFile("content/Common/Stage/M_Dai_Room15.szs@YAZ0@SARC@Room15.bfres@BFRES@room.dzr@DZX");
 
-    et_room15.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(et_room15, FileTypes::DZXFile, data)
+    et_room15.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& et_room15) -> int {
 
         ChunkEntry& swc00_15 = et_room15.add_entity("SCOB");
         swc00_15.data = "SW_C00\x00\x00\x00\x03\xFF\x59\x44\x22\x80\x00\xC4\x8F\xC0\x00\x45\xF0\xA0\x00\x00\x00\x00\x00\x00\x00\xFF\xFF\x1E\x14\x0A\xFF"s;
@@ -2205,9 +2077,7 @@ TweakError prevent_reverse_door_softlocks() {
     // This solves the whole puzzle, so it's a bit cheap and will leave out for now
     // RandoSession::CacheEntry& et_room17 = g_session.openGameFile("content/Common/Stage/M_Dai_Room17.szs@YAZ0@SARC@Room17.bfres@BFRES@room.dzr@DZX");
 
-    // et_room17.addAction([](RandoSession* session, FileType* data) -> int {
-    //     CAST_ENTRY_TO_FILETYPE(et_room17, FileTypes::DZXFile, data)
-
+    // et_room17.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& et_room17) -> int {
     //     ChunkEntry& swc00_17 = et_room17.add_entity("SCOB");
     //     swc00_17.data = "SW_C00\x00\x00\x00\x03\xFF\x62\xC5\x54\x85\x61\xC5\xB0\x22\x41\x44\x9F\x2A\xD7\x00\x00\x00\x00\x00\x00\xFF\xFF\x5F\xEC\x5F\x04"s;
 
@@ -2217,8 +2087,7 @@ TweakError prevent_reverse_door_softlocks() {
     // First Song Stone in Wind Temple if players clip past it
     RandoSession::CacheEntry& wt_room8 = g_session.openGameFile("content/Common/Stage/kaze_Room8.szs@YAZ0@SARC@Room8.bfres@BFRES@room.dzr@DZX");
 
-    wt_room8.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(wt_room8, FileTypes::DZXFile, data)
+    wt_room8.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& wt_room8) -> int {
 
         ChunkEntry& swc00_8 = wt_room8.add_entity("SCOB");
         swc00_8.data = "SW_C00\x00\x00\x00\x03\xFF\x1E\x46\x13\xDB\x2A\x44\x85\x9F\x3A\xC0\xF3\x0B\xAC\x00\x00\x00\x00\x00\x00\xFF\xFF\x1E\x0A\x0A\xFF"s;
@@ -2240,8 +2109,7 @@ TweakError update_tingle_statue_item_get_funcs() {
         const uint32_t item_func_addr = item_get_func_ptr + (statue_id * 0xC) + 8;
         const uint32_t item_func_ptr = custom_symbols.at(symbol_name_by_item_id.at(statue_id));
         
-        rpx.addAction([=](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        rpx.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
             RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, item_func_addr, 9), item_func_ptr - 0x02000000));
 
@@ -2256,8 +2124,7 @@ TweakError make_tingle_statue_reward_rupee_rainbow_colored() {
     const uint32_t item_resources_list_start = 0x101e4674;
     const uint32_t rainbow_rupee_item_resource_addr = item_resources_list_start + 0xB8 * 0x24;
 
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([=](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, rainbow_rupee_item_resource_addr + 0x14), 0x07));
 
@@ -2273,8 +2140,7 @@ TweakError show_seed_hash_on_title_screen(const std::u16string& hash) { //make s
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Layout/Title_00.szs@YAZ0@SARC@blyt/Title_00.bflyt@BFLYT");
     
     //add hash
-    entry.addAction([hash](RandoSession* sessio, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(layout, FileTypes::FLYTFile, data)
+    entry.addAction<FileTypes::FLYTFile>([hash](RandoSession* sessio, FileTypes::FLYTFile& layout) -> int {
 
         Pane& newPane = layout.rootPane.children[0].children[1].children[3].duplicateChildPane(1); //hidden version number text
         txt1& textPane = *dynamic_cast<txt1*>(newPane.pane.get());
@@ -2306,17 +2172,15 @@ TweakError implement_key_bag() {
     for (const auto& language : Text::supported_languages) {
         RandoSession::CacheEntry& charm = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@BtnCollectIcon_00.szs@YAZ0@SARC@timg/CollectIcon118_08^l.bflim@BFLIM");
         
-        charm.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(pirates_charm, FileTypes::FLIMFile, data)
+        charm.addAction<FileTypes::FLIMFile>([](RandoSession* session, FileTypes::FLIMFile& pirates_charm) -> int {
 
-            FILETYPE_ERROR_CHECK(pirates_charm.replaceWithDDS(Utility::get_data_path() / "assets/KeyBag.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, true));
+            FILETYPE_ERROR_CHECK(pirates_charm.replaceWithDDS(Utility::get_data_path() / "assets/KeyBag.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, true, session->getWorkerPool()));
 
             return true;
         });
 
         RandoSession::CacheEntry& units = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@unitString_msbt.szs@YAZ0@SARC@unitString.msbt@MSBT");
-        units.addAction([messages, language](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+        units.addAction<FileTypes::MSBTFile>([messages, language](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
 
             const Message& to_copy = msbt.messages_by_label["Unit_Rupee_00"];
             msbt.addMessage("Unit_Key_00", to_copy.attributes, to_copy.style, u"\0"s);
@@ -2348,8 +2212,7 @@ TweakError show_dungeon_markers_on_chart(World& world) {
     for (const auto& language : Text::supported_languages) {
         RandoSession::CacheEntry& map = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@Map_00.szs@YAZ0@SARC@blyt/Map_00.bflyt@BFLYT");
 
-        map.addAction([room_indexes](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(map, FileTypes::FLYTFile, data)
+        map.addAction<FileTypes::FLYTFile>([room_indexes](RandoSession* session, FileTypes::FLYTFile& map) -> int {
 
             std::vector<size_t> quest_marker_indexes = {
                 144, 145, 146, 147, 148, 149, 150, 151
@@ -2381,8 +2244,8 @@ TweakError show_dungeon_markers_on_chart(World& world) {
 
 TweakError add_chest_in_place_jabun_cutscene() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/Pjavdou_Room0.szs@YAZ0@SARC@Room0.bfres@BFRES@room.dzr");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data) //do this on the stream so it happens before location mod
+    entry.addAction<RawFile>([](RandoSession* session, RawFile& generic) -> int {
+        //do this on the stream so it happens before location mod
 
         FileTypes::DZXFile dzr;
         LOG_AND_RETURN_BOOL_IF_ERR(dzr.loadFromBinary(generic.data));
@@ -2402,8 +2265,7 @@ TweakError add_chest_in_place_jabun_cutscene() {
 
 TweakError add_jabun_obstacles_to_default_layer() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/szs_permanent2.pack@SARC@sea_Room44.szs@YAZ0@SARC@Room44.bfres@BFRES@room.dzr@DZX");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         std::vector<ChunkEntry*> layer_5_actors = dzr.entries_by_type_and_layer("ACTR", 5);
         const std::string layer_5_door_data = layer_5_actors[0]->data;
@@ -2425,8 +2287,7 @@ TweakError add_jabun_obstacles_to_default_layer() {
 
 TweakError remove_jabun_stone_door_event() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/first_szs_permanent.pack@SARC@sea_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@event_list.dat@EVENTS");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(event_list, FileTypes::EventList, data)
+    entry.addAction<FileTypes::EventList>([](RandoSession* session, FileTypes::EventList& event_list) -> int {
         
         if(event_list.Events_By_Name.count("ajav_uzu") == 0) LOG_ERR_AND_RETURN_BOOL(TweakError::MISSING_EVENT);
         std::shared_ptr<Event> unlock_cave_event = event_list.Events_By_Name.at("ajav_uzu");
@@ -2460,8 +2321,8 @@ TweakError remove_jabun_stone_door_event() {
 
 TweakError add_chest_in_place_master_sword() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/kenroom_Room0.szs@YAZ0@SARC@Room0.bfres@BFRES@room.dzr");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data) //do this on the stream so it happens before location mod
+    entry.addAction<RawFile>([](RandoSession* session, RawFile& generic) -> int {
+        //do this on the stream so it happens before location mod
 
         FileTypes::DZXFile dzr;
         LOG_AND_RETURN_BOOL_IF_ERR(dzr.loadFromBinary(generic.data));
@@ -2501,8 +2362,7 @@ TweakError add_chest_in_place_master_sword() {
 
 TweakError fix_totg_warp_spawn() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/sea_Room26.szs@YAZ0@SARC@Room26.bfres@BFRES@room.dzr@DZX");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         const std::vector<ChunkEntry*> spawns = dzr.entries_by_type("PLYR");
         ChunkEntry* spawn = spawns[9];
@@ -2519,8 +2379,7 @@ TweakError remove_phantom_ganon_req_for_reefs() {
         const fspath path = getRoomDzrPath("sea", room_index);
         RandoSession::CacheEntry& entry = g_session.openGameFile(path);
         
-        entry.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(room_dzr, FileTypes::DZXFile, data)
+        entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& room_dzr) -> int {
 
             const std::vector<ChunkEntry*> actors = room_dzr.entries_by_type("ACTR");
             for (ChunkEntry* actor : actors) {
@@ -2545,12 +2404,11 @@ TweakError remove_phantom_ganon_req_for_reefs() {
 
 TweakError fix_ff_door() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/szs_permanent1.pack@SARC@sea_Room1.szs@YAZ0@SARC@Room1.bfres@BFRES@room.dzb");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
+    entry.addAction<RawFile>([](RandoSession* session, RawFile& file) -> int {
         static constexpr int32_t face_index = 0x1493;
         static constexpr uint16_t new_prop_index = 0x0011;
 
-        CAST_ENTRY_TO_FILETYPE(file, RawFile, data)
-        std::stringstream& stream = file.data;
+        Utility::ByteStream& stream = file.data;
 
         stream.seekg(0xC, std::ios::beg);
         
@@ -2729,8 +2587,7 @@ TweakError remove_minor_pan_cs() {
         }
 
         RandoSession::CacheEntry& entry = g_session.openGameFile(path);
-        entry.addAction([cs_info](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(dzx, FileTypes::DZXFile, data)
+        entry.addAction<FileTypes::DZXFile>([cs_info](RandoSession* session, FileTypes::DZXFile& dzx) -> int {
 
             std::vector<ChunkEntry*> scobs = dzx.entries_by_type("SCOB");
             for (ChunkEntry* scob : scobs) {
@@ -2756,8 +2613,7 @@ TweakError remove_minor_pan_cs() {
 }
 
 TweakError fix_stone_head_bugs() {
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         uint32_t status_bits = elfUtil::read_u32(elf, elfUtil::AddressToOffset(elf, 0x101ca100));
         Utility::Endian::toPlatform_inplace(eType::Big, status_bits);
@@ -2773,17 +2629,15 @@ TweakError fix_stone_head_bugs() {
 TweakError show_tingle_statues_on_quest_screen() {
     for (std::string language : Text::supported_languages) {
         RandoSession::CacheEntry& icon = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@BtnMapIcon_00.szs@YAZ0@SARC@timg/MapBtn_00^l.bflim@BFLIM");
-        icon.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(tingle, FileTypes::FLIMFile, data)
-            FILETYPE_ERROR_CHECK(tingle.replaceWithDDS(Utility::get_data_path() / "assets/Tingle.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, true));
+        icon.addAction<FileTypes::FLIMFile>([](RandoSession* session, FileTypes::FLIMFile& tingle) -> int {
+            FILETYPE_ERROR_CHECK(tingle.replaceWithDDS(Utility::get_data_path() / "assets/Tingle.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, true, session->getWorkerPool()));
 
             return true;
         });
 
         RandoSession::CacheEntry& shadow = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@BtnMapIcon_00.szs@YAZ0@SARC@timg/MapBtn_07^t.bflim@BFLIM");
-        shadow.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(shadow, FileTypes::FLIMFile, data)
-            FILETYPE_ERROR_CHECK(shadow.replaceWithDDS(Utility::get_data_path() / "assets/TingleShadow.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, false));
+        shadow.addAction<FileTypes::FLIMFile>([](RandoSession* session, FileTypes::FLIMFile& shadow) -> int {
+            FILETYPE_ERROR_CHECK(shadow.replaceWithDDS(Utility::get_data_path() / "assets/TingleShadow.dds", GX2TileMode::GX2_TILE_MODE_DEFAULT, 0, false, session->getWorkerPool()));
 
             return true;
         });
@@ -2794,8 +2648,7 @@ TweakError show_tingle_statues_on_quest_screen() {
 
 TweakError add_shortcut_warps_into_dungeons() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/szs_permanent2.pack@SARC@sea_Room41.szs@YAZ0@SARC@Room41.bfres@BFRES@room.dzr@DZX");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         ChunkEntry& sw_c00 = dzr.add_entity("SCOB");
         sw_c00.data = "SW_C00\x00\x00\x00\x03\xFF\x7F\x48\x40\x24\xED\x45\x44\x99\xB1\x48\x41\x7B\x63\x00\x00\x00\x00\x00\x00\xFF\xFF\x96\x14\x28\xFF"s;
@@ -2816,14 +2669,12 @@ TweakError update_entrance_events() {
     RandoSession::CacheEntry& dzr = g_session.openGameFile("content/Common/Pack/szs_permanent2.pack@SARC@sea_Room41.szs@YAZ0@SARC@Room41.bfres@BFRES@room.dzr@DZX");
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/first_szs_permanent.pack@SARC@sea_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@event_list.dat@EVENTS");
     
-    dzr.addAction([&entry](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    dzr.addAction<FileTypes::DZXFile>([&entry](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         const ChunkEntry* waterfall = dzr.entries_by_type("SCLS")[7];
         //ChunkEntry* gallery = dzr.entries_by_type("SCLS")[8]; // not currently randomized
 
-        entry.addAction([waterfall = *waterfall](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(event_list, FileTypes::EventList, data)
+        entry.addAction<FileTypes::EventList>([waterfall = *waterfall](RandoSession* session, FileTypes::EventList& event_list) -> int {
 
             if(event_list.Events_By_Name.count("fall") == 0) LOG_ERR_AND_RETURN_BOOL(TweakError::MISSING_EVENT);
             std::shared_ptr<Action> loadRoom = event_list.Events_By_Name.at("fall")->get_actor("DIRECTOR")->actions[1];
@@ -2854,8 +2705,7 @@ TweakError fix_entrance_params() {
 
     //set our custom param for the crawlspaces so they always have Link crawling
     RandoSession::CacheEntry& link_ug = g_session.openGameFile("content/Common/Stage/LinkUG_Room0.szs@YAZ0@SARC@Room0.bfres@BFRES@room.dzr@DZX");
-    link_ug.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    link_ug.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         const std::vector<ChunkEntry*> spawns = dzr.entries_by_type("PLYR");
         spawns[1]->data.data()[0x19] |= 0x01; //last byte of X rotation
@@ -2864,8 +2714,7 @@ TweakError fix_entrance_params() {
     });
 
     RandoSession::CacheEntry& outset_exit = g_session.openGameFile("content/Common/Pack/szs_permanent2.pack@SARC@sea_Room44.szs@YAZ0@SARC@Room44.bfres@BFRES@room.dzr@DZX");
-    outset_exit.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    outset_exit.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         const std::vector<ChunkEntry*> spawns = dzr.entries_by_type("PLYR");
         spawns[23]->data.data()[0x19] |= 0x01;
@@ -2874,8 +2723,7 @@ TweakError fix_entrance_params() {
     });
 
     RandoSession::CacheEntry& bomb_shop = g_session.openGameFile("content/Common/Stage/Obombh_Room0.szs@YAZ0@SARC@Room0.bfres@BFRES@room.dzr@DZX");
-    bomb_shop.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    bomb_shop.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         const std::vector<ChunkEntry*> spawns = dzr.entries_by_type("PLYR");
         spawns[1]->data.data()[0x19] |= 0x01;
@@ -2889,8 +2737,7 @@ TweakError fix_entrance_params() {
     });
 
     RandoSession::CacheEntry& windfall_exit = g_session.openGameFile("content/Common/Pack/szs_permanent1.pack@SARC@sea_Room11.szs@YAZ0@SARC@Room11.bfres@BFRES@room.dzr@DZX");
-    windfall_exit.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    windfall_exit.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         const std::vector<ChunkEntry*> spawns = dzr.entries_by_type("PLYR");
         spawns[2]->data.data()[0x19] |= 0x01;
@@ -2908,10 +2755,9 @@ TweakError fix_entrance_params() {
 
 TweakError replace_ctmc_chest_texture() {
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Pack/permanent_3d.pack@SARC@Dalways.szs@YAZ0@SARC@Dalways.bfres@BFRES");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(bfres, FileTypes::resFile, data)
+    entry.addAction<FileTypes::resFile>([](RandoSession* session, FileTypes::resFile& bfres) -> int {
 
-        FILETYPE_ERROR_CHECK(bfres.textures[3].replaceImageData(Utility::get_data_path() / "assets/KeyChest.dds", GX2TileMode::GX2_TILE_MODE_TILED_2D_THIN1, 0, true, true));
+        FILETYPE_ERROR_CHECK(bfres.textures[3].replaceImageData(Utility::get_data_path() / "assets/KeyChest.dds", GX2TileMode::GX2_TILE_MODE_TILED_2D_THIN1, 0, true, true, session->getWorkerPool()));
 
         return true;
     });
@@ -2933,14 +2779,15 @@ TweakError apply_ingame_preferences(const Settings& settings) {
     const uint32_t ui_display_preference_addr = custom_symbols.at("ui_display_preference");
 
     RandoSession::CacheEntry& entry = g_session.openGameFile("code/cking.rpx@RPX@ELF");
-    entry.addAction([=](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data);
+    entry.addAction<FileTypes::ELF>([=](RandoSession* session, FileTypes::ELF& elf) -> int {
 
-        RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, target_type_preference_addr), static_cast<std::underlying_type_t<TargetTypePreference>>(settings.target_type)));
-        RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, camera_preference_addr), static_cast<std::underlying_type_t<CameraPreference>>(settings.camera)));
-        RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, first_person_camera_preference_addr), static_cast<std::underlying_type_t<FirstPersonCameraPreference>>(settings.first_person_camera)));
-        RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, gyroscope_preference_addr), static_cast<std::underlying_type_t<GyroscopePreference>>(settings.gyroscope)));
-        RPX_ERROR_CHECK(elfUtil::write_u8(elf, elfUtil::AddressToOffset(elf, ui_display_preference_addr), static_cast<std::underlying_type_t<UIDisplayPreference>>(settings.ui_display)));
+        elfUtil::WriteBatch batch;
+        batch.write_u8(target_type_preference_addr, static_cast<std::underlying_type_t<TargetTypePreference>>(settings.target_type));
+        batch.write_u8(camera_preference_addr, static_cast<std::underlying_type_t<CameraPreference>>(settings.camera));
+        batch.write_u8(first_person_camera_preference_addr, static_cast<std::underlying_type_t<FirstPersonCameraPreference>>(settings.first_person_camera));
+        batch.write_u8(gyroscope_preference_addr, static_cast<std::underlying_type_t<GyroscopePreference>>(settings.gyroscope));
+        batch.write_u8(ui_display_preference_addr, static_cast<std::underlying_type_t<UIDisplayPreference>>(settings.ui_display));
+        RPX_ERROR_CHECK(batch.apply(elf));
 
         return true;
     });
@@ -2951,25 +2798,23 @@ TweakError apply_ingame_preferences(const Settings& settings) {
 TweakError updateCodeSize() {
     //Increase the max codesize in cos.xml to load all our code
     RandoSession::CacheEntry& cosEntry = g_session.openGameFile("code/cos.xml");
-    cosEntry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(generic, RawFile, data)\
-        std::stringstream& cosStream = generic.data;
+    cosEntry.addAction<RawFile>([](RandoSession* session, RawFile& generic) -> int {
+        Utility::ByteStream& cosStream = generic.data;
 
         tinyxml2::XMLDocument cos;
-        cos.Parse(cosStream.str().c_str(), cosStream.str().size());
+        cos.Parse(cosStream.data(), cosStream.size());
         tinyxml2::XMLElement* root = cos.RootElement();
         root->FirstChildElement("max_codesize")->SetText("02080000");
         tinyxml2::XMLPrinter printer;
         cos.Print(&printer);
-        cosStream.str(printer.CStr());
+        cosStream.assign(std::string_view(printer.CStr()));
 
         return true;
     });
 
     //Also update the RPL info section of the RPX
     //Change the textSize and loadSize to be large enough for the new code/relocations
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
         
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x00000004, 32), 0x00909510));
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x0000001C, 32), 0x00379000));
@@ -2991,8 +2836,7 @@ TweakError fix_needle_rock_island_salvage_flags() {
     // with the two non-golden gunboat salvages.
   
     RandoSession::CacheEntry& entry = g_session.openGameFile("content/Common/Stage/sea_Room29.szs@YAZ0@SARC@Room29.bfres@BFRES@room.dzr@DZX");
-    entry.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    entry.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
         std::vector<ChunkEntry*> salvages;
         static const std::unordered_set<std::string> salvage_object_names = {
             "Salvage\0"s,
@@ -3027,8 +2871,7 @@ TweakError add_ff_warp_button() {
         RandoSession::CacheEntry& map = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@WarpMap_00.szs@YAZ0@SARC@blyt/WarpMap_00.bflyt@BFLYT");
 
         //add another WarpArea pane
-        map.addAction([](RandoSession* sessio, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(layout, FileTypes::FLYTFile, data)
+        map.addAction<FileTypes::FLYTFile>([](RandoSession* sessio, FileTypes::FLYTFile& layout) -> int {
 
             Pane& newPane = layout.rootPane.children[0].duplicateChildPane(4); //L_WarpArea_00
             prt1& partPane = *dynamic_cast<prt1*>(newPane.pane.get());
@@ -3042,8 +2885,7 @@ TweakError add_ff_warp_button() {
         
         RandoSession::CacheEntry& text = g_session.openGameFile("content/Common/Pack/permanent_2d_Us" + language + ".pack@SARC@message_msbt.szs@YAZ0@SARC@message.msbt@MSBT");
     
-        text.addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+        text.addAction<FileTypes::MSBTFile>([](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
 
             const Message& to_copy = msbt.messages_by_label["00075"];
             msbt.addMessage("00076", to_copy.attributes, to_copy.style, u"");
@@ -3059,8 +2901,7 @@ TweakError add_ff_warp_button() {
 TweakError fix_vanilla_text() {
     //The spanish text for the 99 quiver says that you can hold up to 99 bombs
     RandoSession::CacheEntry& text = g_session.openGameFile("content/Common/Pack/permanent_2d_UsSpanish.pack@SARC@message_msbt.szs@YAZ0@SARC@message.msbt@MSBT");
-    text.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(msbt, FileTypes::MSBTFile, data)
+    text.addAction<FileTypes::MSBTFile>([](RandoSession* session, FileTypes::MSBTFile& msbt) -> int {
 
         std::u16string& message = msbt.messages_by_label["00277"].text.message;
         message.replace(message.find(u"bombas"), 6, u"flechas", 7);
@@ -3080,8 +2921,7 @@ TweakError allow_nonlinear_servants_of_the_towers() {
     RandoSession::CacheEntry& list = g_session.openGameFile("content/Common/Stage/Siren_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@event_list.dat@EVENTS");
     RandoSession::CacheEntry& hub_room = g_session.openGameFile("content/Common/Stage/Siren_Room7.szs@YAZ0@SARC@Room7.bfres@BFRES@room.dzr@DZX");
     
-    totg.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzs, FileTypes::DZXFile, data)
+    totg.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzs) -> int {
 
         std::vector<ChunkEntry*> doors = dzs.entries_by_type("TGDR");
         ChunkEntry* north_door = doors[6];
@@ -3124,8 +2964,7 @@ TweakError allow_nonlinear_servants_of_the_towers() {
     // The switch set by the tablet when you get its item is changed to 0x2B (unused in vanilla).
     // Once all fourth switches are set, the light beam warp appears.
 
-    hub_room.addAction([=](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    hub_room.addAction<FileTypes::DZXFile>([=](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         std::vector<ChunkEntry*> actors = dzr.entries_by_type("ACTR");
         for (ChunkEntry* actor : actors) {
@@ -3159,8 +2998,7 @@ TweakError allow_nonlinear_servants_of_the_towers() {
 
     // East servant returned.
     // Make this servant set its switch directly, instead of making the Command Melody tablet appear and then having the tablet set the switch.
-    list.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(event_list, FileTypes::EventList, data)
+    list.addAction<FileTypes::EventList>([](RandoSession* session, FileTypes::EventList& event_list) -> int {
         
         if(event_list.Events_By_Name.count("Os_Finish") == 0) LOG_ERR_AND_RETURN_BOOL(TweakError::MISSING_EVENT);
         std::shared_ptr<Event> os0_finish = event_list.Events_By_Name.at("Os_Finish");
@@ -3428,8 +3266,7 @@ TweakError allow_nonlinear_servants_of_the_towers() {
         return true;
     });
 
-    hub_room.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    hub_room.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         // Detect when any servant has been returned and start the tablet event (hardcode evnt index because it avoids a file dependency, not great but whatever).
         ChunkEntry& swop = dzr.add_entity("ACTR");
@@ -3450,8 +3287,7 @@ TweakError make_dungeon_joy_pendants_flexible() {
     // The joy pendant pot in the FW maze room doesn't have an item pickup flag set, which seems accidental
     // Give it an unused flag so you can only get the item once
     RandoSession::CacheEntry& maze_room = g_session.openGameFile("content/Common/Stage/kindan_Room7.szs@YAZ0@SARC@Room7.bfres@BFRES@room.dzr@DZX");
-    maze_room.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    maze_room.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         ChunkEntry* pot = dzr.entries_by_type_and_layer("ACTR", DEFAULT_LAYER)[0xE0];
         pot->data[9] = 0x16;
@@ -3462,8 +3298,7 @@ TweakError make_dungeon_joy_pendants_flexible() {
     // The stone heads with joy pendants will stay destroyed until you reload the dungeon, even if you haven't collected the item
     // This can be confusing and look like a softlock under some circumstances (even though it isn't), so change them to always reappear
     RandoSession::CacheEntry& turn_floor_room = g_session.openGameFile("content/Common/Stage/kaze_Room1.szs@YAZ0@SARC@Room1.bfres@BFRES@room.dzr@DZX");
-    turn_floor_room.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    turn_floor_room.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         ChunkEntry* stone_head = dzr.entries_by_type_and_layer("ACTR", DEFAULT_LAYER)[0x10];
         stone_head->data[8] = 0xFF;
@@ -3472,8 +3307,7 @@ TweakError make_dungeon_joy_pendants_flexible() {
     });
 
     RandoSession::CacheEntry& many_cyclones_room = g_session.openGameFile("content/Common/Stage/kaze_Room7.szs@YAZ0@SARC@Room7.bfres@BFRES@room.dzr@DZX");
-    many_cyclones_room.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    many_cyclones_room.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         ChunkEntry* stone_head = dzr.entries_by_type_and_layer("ACTR", DEFAULT_LAYER)[0x2E];
         stone_head->data[8] = 0xFF;
@@ -3489,8 +3323,7 @@ TweakError prevent_fairy_island_softlocks() {
     // Move out the ring of flames slightly so Link doesn't immediately get hit
     RandoSession::CacheEntry& wfi_dzr = g_session.openGameFile("content/Common/Stage/sea_Room15.szs@YAZ0@SARC@Room15.bfres@BFRES@room.dzr@DZX");
 
-    wfi_dzr.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    wfi_dzr.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
         
         std::vector<ChunkEntry*> spawns = dzr.entries_by_type("PLYR");
         for (ChunkEntry* spawn : spawns) {
@@ -3511,8 +3344,7 @@ TweakError give_fairy_fountains_distinct_colors() {
     for (const std::string& stageName : {"Fairy01", "Fairy02", "Fairy03", "Fairy04", "Fairy05", "Fairy06"}) {
         RandoSession::CacheEntry& fountain = g_session.openGameFile("content/Common/Stage/" + stageName + "_Stage.szs@YAZ0@SARC@Stage.bfres@BFRES@stage.dzs@DZX");
 
-        fountain.addAction([hue](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(dzs, FileTypes::DZXFile, data)
+        fountain.addAction<FileTypes::DZXFile>([hue](RandoSession* session, FileTypes::DZXFile& dzs) -> int {
 
             for (ChunkEntry* pale : dzs.entries_by_type("Pale")) {
                 HSV bg0_c0 = RGBToHSV((uint8_t)pale->data[6] / 255.0, (uint8_t)pale->data[7] / 255.0, (uint8_t)pale->data[8] / 255.0);
@@ -3544,8 +3376,7 @@ TweakError fix_second_quest_locations() {
     // The Outset chart's salvage point is inside the whirlpool in NG+, locking it behind bombs
     // Logic does not account for this (normal files never require bombs) so it could be problematic in rare cases
     RandoSession::CacheEntry& outset = g_session.openGameFile("content/Common/Pack/szs_permanent2.pack@SARC@sea_Room44.szs@YAZ0@SARC@Room44.bfres@BFRES@room.dzr@DZX");
-    outset.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(dzr, FileTypes::DZXFile, data)
+    outset.addAction<FileTypes::DZXFile>([](RandoSession* session, FileTypes::DZXFile& dzr) -> int {
 
         const std::vector<ChunkEntry*> scobs = dzr.entries_by_type_and_layer("SCOB", DEFAULT_LAYER);
         for(const size_t& salvage_scob_index : {21, 49, 50, 51, 55}) {
@@ -3559,8 +3390,7 @@ TweakError fix_second_quest_locations() {
     });
 
     RandoSession::CacheEntry& charts = g_session.openGameFile("content/Common/Misc/Misc.szs@YAZ0@SARC@Misc.bfres@BFRES@cmapdat.bin@CHARTS");
-    charts.addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(charts, FileTypes::ChartList, data)
+    charts.addAction<FileTypes::ChartList>([](RandoSession* session, FileTypes::ChartList& charts) -> int {
 
         const auto outset_chart = std::find_if(charts.charts.begin(), charts.charts.end(), [&](const Chart& chart) { return chart.getIslandNumber() == 44; });
         if(outset_chart == charts.charts.end()) return false;
@@ -3576,26 +3406,25 @@ TweakError fix_second_quest_locations() {
 }
 
 TweakError apply_necessary_tweaks(const Settings& settings) {
-    LOG_AND_RETURN_IF_ERR(Load_Custom_Symbols(Utility::get_data_path() / "asm/custom_symbols.yaml"));
+    LOG_AND_RETURN_IF_ERR(Load_Custom_Symbols(Utility::get_data_path() / "asm/custom_symbols.bin"));
 
     const std::string seedHash = LogInfo::getSeedHash();
     const std::u16string u16_seedHash = Utility::Str::toUTF16(seedHash);
 
     TWEAK_ERR_CHECK(updateCodeSize());
 
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/custom_funcs_diff.yaml"));
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/make_game_nonlinear_diff.yaml"));
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/make_all_figurines_obtainable_diff.yaml"));
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/remove_cutscenes_diff.yaml"));
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/flexible_entrances_diff.yaml"));
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/flexible_hint_locations_diff.yaml"));
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/flexible_item_locations_diff.yaml"));
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/fix_vanilla_bugs_diff.yaml"));
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/misc_rando_features_diff.yaml"));
-    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/switch_op_diff.yaml"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/custom_funcs_diff.bin"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/make_game_nonlinear_diff.bin"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/make_all_figurines_obtainable_diff.bin"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/remove_cutscenes_diff.bin"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/flexible_entrances_diff.bin"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/flexible_hint_locations_diff.bin"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/flexible_item_locations_diff.bin"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/fix_vanilla_bugs_diff.bin"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/misc_rando_features_diff.bin"));
+    LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/switch_op_diff.bin"));
 
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
 
         //Elf32_Rela blockMoveReloc;
         //blockMoveReloc.r_offset = custom_symbols.at("load_uncompressed_szs") + 0x28;
@@ -3617,46 +3446,44 @@ TweakError apply_necessary_tweaks(const Settings& settings) {
 
     //Update hurricane spin item func, not done through asm because of relocation things
     if(custom_symbols.count("hurricane_spin_item_func") == 0) LOG_ERR_AND_RETURN(TweakError::MISSING_SYMBOL);
-    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([](RandoSession* session, FileType* data) -> int {
-        CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+    g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
         
         RPX_ERROR_CHECK(elfUtil::write_u32(elf, elfUtil::AddressToOffset(elf, 0x0001DA54 + (0xAA * 0xC) + 8, 9), custom_symbols.at("hurricane_spin_item_func") - 0x02000000));
         return true;
     });
 
     if (settings.instant_text_boxes) {
-        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/b_button_skips_text_diff.yaml"));
+        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/b_button_skips_text_diff.bin"));
         TWEAK_ERR_CHECK(make_all_text_instant());
     }
     if (settings.quiet_swift_sail) {
-        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/quiet_swift_sail_diff.yaml"));
+        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/quiet_swift_sail_diff.bin"));
     }
     if (settings.fix_rng) {
-        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/fix_rng_diff.yaml"));
+        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/fix_rng_diff.bin"));
     }
     if (settings.performance) {
-        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/performance_diff.yaml"));
+        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/performance_diff.bin"));
     }
     if (settings.classic_mode) {
-        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/classic_features_diff.yaml"));
+        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/classic_features_diff.bin"));
     }
     if (settings.reveal_full_sea_chart) {
-        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/reveal_sea_chart_diff.yaml"));
+        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/reveal_sea_chart_diff.bin"));
     }
     if (settings.invert_sea_compass_x_axis) {
-        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/invert_sea_compass_x_axis_diff.yaml"));
+        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/invert_sea_compass_x_axis_diff.bin"));
     }
     if (settings.remove_swords) {
-        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/swordless_diff.yaml"));
-        g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction([](RandoSession* session, FileType* data) -> int {
-            CAST_ENTRY_TO_FILETYPE(elf, FileTypes::ELF, data)
+        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/swordless_diff.bin"));
+        g_session.openGameFile("code/cking.rpx@RPX@ELF").addAction<FileTypes::ELF>([](RandoSession* session, FileTypes::ELF& elf) -> int {
 
             RPX_ERROR_CHECK(elfUtil::removeRelocation(elf, {7, 0x001C1ED4})); //would overwrite branch to custom code
             return true;
         });
     }
     if (settings.remove_music) {
-        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/remove_music_diff.yaml"));
+        LOG_AND_RETURN_IF_ERR(Apply_Patch(Utility::get_data_path() / "asm/patch_diffs/remove_music_diff.bin"));
     }
     if(settings.chest_type_matches_contents) {
         TWEAK_ERR_CHECK(replace_ctmc_chest_texture());
@@ -0,0 +1,167 @@
+#include "buffer.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+
+
+namespace Utility {
+    ByteBuffer::ByteBuffer(std::span<const char> data_) {
+        assign(data_);
+    }
+
+    size_t ByteBuffer::size() const {
+        return std::max(length, static_cast<size_t>(pptr() - pbase()));
+    }
+
+    void ByteBuffer::assign(std::span<const char> data_) {
+        storage.assign(data_.begin(), data_.end());
+        length = storage.size();
+        setPointers(0, 0);
+    }
+
+    void ByteBuffer::assign(std::vector<char>&& data_) {
+        storage = std::move(data_);
+        length = storage.size();
+        setPointers(0, 0);
+    }
+
+    void ByteBuffer::resize(const size_t& newSize) {
+        if(newSize > storage.size()) {
+            storage.resize(newSize);
+        }
+        else {
+            // zero anything between the new size and old size so growing later doesn't expose stale bytes
+            std::fill(storage.begin() + newSize, storage.begin() + std::max(newSize, size()), '\0');
+        }
+
+        length = newSize;
+        setPointers(0, 0);
+    }
+
+    void ByteBuffer::release() {
+        std::vector<char>().swap(storage);
+        length = 0;
+        setg(nullptr, nullptr, nullptr);
+        setp(nullptr, nullptr);
+    }
+
+    std::vector<char> ByteBuffer::take() {
+        syncLength();
+        storage.resize(length);
+
+        std::vector<char> out = std::move(storage);
+        release();
+        return out;
+    }
+
+    void ByteBuffer::reserve(const size_t& capacity) {
+        if(capacity <= storage.size()) return;
+
+        syncLength();
+        const size_t getPos = gptr() - eback();
+        const size_t putPos = pptr() - pbase();
+        storage.resize(capacity);
+        setPointers(getPos, putPos);
+    }
+
+    void ByteBuffer::syncLength() {
+        length = size();
+    }
+
+    void ByteBuffer::grow(const size_t& minCapacity) {
+        storage.resize(std::max({minCapacity, storage.size() * 2, size_t(0x100)}));
+    }
+
+    void ByteBuffer::setPointers(const size_t& getPos, const size_t& putPos) {
+        char* base = storage.data();
+        setg(base, base + getPos, base + length);
+        setPutPos(putPos);
+    }
+
+    void ByteBuffer::setPutPos(const size_t& putPos) {
+        setp(storage.data(), storage.data() + storage.size());
+
+        // pbump only takes an int
+        size_t remaining = putPos;
+        while(remaining > 0) {
+            const int step = static_cast<int>(std::min<size_t>(remaining, INT_MAX));
+            pbump(step);
+            remaining -= step;
+        }
+    }
+
+    ByteBuffer::int_type ByteBuffer::underflow() {
+        // writes may have moved the end of the data since the get area was set
+        syncLength();
+        const size_t getPos = gptr() - eback();
+        if(getPos >= length) return traits_type::eof();
+
+        setg(storage.data(), storage.data() + getPos, storage.data() + length);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    ByteBuffer::int_type ByteBuffer::overflow(int_type ch) {
+        if(traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+
+        syncLength();
+        const size_t getPos = gptr() - eback();
+        const size_t putPos = pptr() - pbase();
+        grow(putPos + 1);
+        setPointers(getPos, putPos);
+
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+        return ch;
+    }
+
+    std::streamsize ByteBuffer::xsputn(const char_type* s, std::streamsize count) {
+        if(count <= 0) return 0;
+
+        const size_t putPos = pptr() - pbase();
+        if(putPos + count > storage.size()) {
+            syncLength();
+            const size_t getPos = gptr() - eback();
+            grow(putPos + count);
+            setPointers(getPos, putPos);
+        }
+
+        std::memcpy(pptr(), s, count);
+        setPutPos(putPos + count);
+        return count;
+    }
+
+    ByteBuffer::pos_type ByteBuffer::seekoff(off_type off, std::ios::seekdir dir, std::ios::openmode which) {
+        const bool in = (which & std::ios::in) != 0;
+        const bool out = (which & std::ios::out) != 0;
+        if(!in && !out) return pos_type(off_type(-1));
+        if(in && out && dir == std::ios::cur) return pos_type(off_type(-1)); // ambiguous, matches std::stringbuf
+
+        syncLength();
+        off_type base = 0;
+        if(dir == std::ios::cur) {
+            base = in ? gptr() - eback() : pptr() - pbase();
+        }
+        else if(dir == std::ios::end) {
+            base = length;
+        }
+
+        // like std::stringbuf, seeking past the end of the data fails
+        const off_type newPos = base + off;
+        if(newPos < 0 || static_cast<size_t>(newPos) > length) return pos_type(off_type(-1));
+
+        if(in) {
+            setg(storage.data(), storage.data() + newPos, storage.data() + length);
+        }
+        if(out) {
+            setPutPos(newPos);
+        }
+
+        return pos_type(newPos);
+    }
+
+    ByteBuffer::pos_type ByteBuffer::seekpos(pos_type pos, std::ios::openmode which) {
+        return seekoff(off_type(pos), std::ios::beg, which);
+    }
+}
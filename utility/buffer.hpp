@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <istream>
+#include <streambuf>
+
+
+
+namespace Utility {
+    // Contiguous, growable byte storage with a seekable stream interface
+    // Data can be read/written through std::istream/std::ostream or accessed directly through spans
+    // Unlike std::stringbuf, viewing the contents never copies them
+    class ByteBuffer final : public std::streambuf {
+    public:
+        ByteBuffer() = default;
+        explicit ByteBuffer(std::span<const char> data_);
+
+        ByteBuffer(const ByteBuffer&) = delete;
+        ByteBuffer& operator=(const ByteBuffer&) = delete;
+
+        char* data() { return storage.data(); }
+        const char* data() const { return storage.data(); }
+        size_t size() const;
+        std::span<char> span() { return { storage.data(), size() }; }
+        std::span<const char> span() const { return { storage.data(), size() }; }
+        std::string_view view() const { return { storage.data(), size() }; }
+
+        // These reset the read/write positions to the start of the buffer
+        void assign(std::span<const char> data_);
+        void assign(std::vector<char>&& data_); // takes the vector's memory instead of copying it
+        void resize(const size_t& newSize); // new bytes are zeroed, meant to be filled through data()
+        void release(); // empty the buffer and free its memory
+        std::vector<char> take(); // moves the contents out without copying, leaves the buffer empty
+
+        void reserve(const size_t& capacity);
+
+    protected:
+        int_type underflow() override;
+        int_type overflow(int_type ch) override;
+        std::streamsize xsputn(const char_type* s, std::streamsize count) override;
+        pos_type seekoff(off_type off, std::ios::seekdir dir, std::ios::openmode which = std::ios::in | std::ios::out) override;
+        pos_type seekpos(pos_type pos, std::ios::openmode which = std::ios::in | std::ios::out) override;
+
+    private:
+        std::vector<char> storage; // storage.size() is the writable capacity
+        size_t length = 0; // logical size, the put pointer may be past this until syncLength()
+
+        void syncLength();
+        void grow(const size_t& minCapacity);
+        void setPointers(const size_t& getPos, const size_t& putPos);
+        void setPutPos(const size_t& putPos);
+    };
+
+    // iostream that owns a ByteBuffer, stand-in for std::stringstream
+    class ByteStream final : public std::iostream {
+    public:
+        ByteStream() : std::iostream(nullptr) { rdbuf(&buffer); }
+        explicit ByteStream(std::span<const char> data_) : std::iostream(nullptr), buffer(data_) { rdbuf(&buffer); }
+
+        ByteStream(const ByteStream&) = delete;
+        ByteStream& operator=(const ByteStream&) = delete;
+
+        ByteBuffer& buf() { return buffer; }
+        const ByteBuffer& buf() const { return buffer; }
+
+        char* data() { return buffer.data(); }
+        const char* data() const { return buffer.data(); }
+        size_t size() const { return buffer.size(); }
+        std::span<char> span() { return buffer.span(); }
+        std::span<const char> span() const { return buffer.span(); }
+        std::string_view view() const { return buffer.view(); }
+
+        // These also clear any error state on the stream
+        void assign(std::span<const char> data_) { buffer.assign(data_); clear(); }
+        void assign(std::vector<char>&& data_) { buffer.assign(std::move(data_)); clear(); }
+        void resize(const size_t& newSize) { buffer.resize(newSize); clear(); }
+        void release() { buffer.release(); clear(); }
+        std::vector<char> take() { std::vector<char> out = buffer.take(); clear(); return out; }
+
+        void reserve(const size_t& capacity) { buffer.reserve(capacity); }
+
+    private:
+        ByteBuffer buffer;
+    };
+}
@@ -2,6 +2,7 @@
 
 #include <utility/string.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 HSV RGBToHSV(const double& r, const double& g, const double& b) {
@@ -160,16 +161,7 @@ bool isValidHexColor(const std::string& hexColor) {
     return hexColor.find_first_not_of("0123456789ABCDEFabcdef") == std::string_view::npos && hexColor.length() == 6;
 }
 
-// Takes 16-bit base, replacement, and current colors.
-// Outputs what the new 16-bit color in place of the current color should
-// be based on the difference between the base and replacement colors 
-uint16_t colorExchange(const uint16_t& baseColor, const uint16_t& replacementColor, const uint16_t& curColor) {
-
-    // Translate 16-bit colors into HSV color space
-    auto baseColorHSV = color16BitToHSV(baseColor);
-    auto replacementColorHSV = color16BitToHSV(replacementColor);
-    auto curColorHSV = color16BitToHSV(curColor);
-
+static uint16_t colorExchange(const HSV& baseColorHSV, const HSV& replacementColorHSV, HSV curColorHSV) {
     // Calculate difference between base and replacement colors
     double sChange = replacementColorHSV.S - baseColorHSV.S;
     double vChange = replacementColorHSV.V - baseColorHSV.V;
@@ -191,6 +183,25 @@ uint16_t colorExchange(const uint16_t& baseColor, const uint16_t& replacementCol
     return colorHSVTo16Bit(newColorHSV);
 }
 
+// Takes 16-bit base, replacement, and current colors.
+// Outputs what the new 16-bit color in place of the current color should
+// be based on the difference between the base and replacement colors 
+uint16_t colorExchange(const uint16_t& baseColor, const uint16_t& replacementColor, const uint16_t& curColor) {
+
+    // Translate 16-bit colors into HSV color space
+    return colorExchange(color16BitToHSV(baseColor), color16BitToHSV(replacementColor), color16BitToHSV(curColor));
+}
+
+void buildColorExchangeTable(const uint16_t& baseColor, const uint16_t& replacementColor, ColorExchangeTable& out) {
+    // Only the current color changes, so the base and replacement are converted once
+    const HSV baseColorHSV = color16BitToHSV(baseColor);
+    const HSV replacementColorHSV = color16BitToHSV(replacementColor);
+
+    for (size_t curColor = 0; curColor < out.size(); curColor++) {
+        out[curColor] = colorExchange(baseColorHSV, replacementColorHSV, color16BitToHSV(curColor));
+    }
+}
+
 std::string HSVShiftColor(const std::string& hexColor, const int& hShift, const int& vShift) {
     auto colorRGB = hexColorStrToRGB(hexColor);
     auto colorHSV = RGBToHSV(colorRGB);
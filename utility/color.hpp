@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include <utility/common.hpp>
 
 template<typename T> requires std::is_arithmetic_v<T>
@@ -105,6 +107,11 @@ bool isValidHexColor(const std::string& hexColor);
 
 uint16_t colorExchange(const uint16_t& baseColor, const uint16_t& replacementColor, const uint16_t& curColor);
 
+// colorExchange for every 16-bit color with one base/replacement pair, indexed by the current color (128 KiB)
+using ColorExchangeTable = std::array<uint16_t, 0x10000>;
+
+void buildColorExchangeTable(const uint16_t& baseColor, const uint16_t& replacementColor, ColorExchangeTable& out);
+
 std::string HSVShiftColor(const std::string& hexColor, const int& hShift, const int& vShift);
 
 std::pair<int, int> get_random_h_and_v_shifts_for_custom_color(const std::string& hexColor);
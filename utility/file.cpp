@@ -10,6 +10,14 @@
 #include <utility/thread_local.hpp>
 
 
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/ioctl.h>
+    #include <sys/stat.h>
+    #include <linux/fs.h>
+#endif
+
 #if defined(QT_GUI) && defined(EMBED_DATA)
     #include <QResource>
     #include <QFile>
@@ -127,6 +135,53 @@ namespace Utility {
         return true;
     }
 
+    #ifndef DEVKITPRO
+        bool clone_file(const fspath& from, const fspath& to) {
+            #ifdef __linux__
+                // let the kernel do the copy instead of bouncing everything through userspace
+                const int src = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+                if(src < 0) return false;
+
+                struct stat srcStat;
+                if(fstat(src, &srcStat) != 0) {
+                    close(src);
+                    return false;
+                }
+
+                const int dst = open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, srcStat.st_mode & 0777);
+                if(dst < 0) {
+                    close(src);
+                    return false;
+                }
+
+                // reflink shares the data on filesystems that support it (btrfs, xfs), nothing is actually copied
+                bool copied = ioctl(dst, FICLONE, src) == 0;
+                if(!copied) {
+                    copied = true;
+                    for(off_t remaining = srcStat.st_size; remaining > 0; ) {
+                        const ssize_t count = copy_file_range(src, nullptr, dst, nullptr, remaining, 0);
+                        if(count <= 0) {
+                            copied = false;
+                            break;
+                        }
+                        remaining -= count;
+                    }
+                }
+
+                close(src);
+                close(dst);
+                if(copied) return true;
+                // older kernels can't copy_file_range across filesystems, use the normal copy below
+            #endif
+
+            std::error_code ec;
+            #if defined(WIN32) && defined(__GNUG__)
+                std::filesystem::remove(to, ec); //same overwrite bug as copy_file
+            #endif
+            return std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, ec);
+        }
+    #endif
+
     // Short function for getting the string data from a file
     int getFileContents(const fspath& filename, std::string& fileContents, bool resourceFile /*= false*/)
     {
@@ -175,4 +230,28 @@ namespace Utility {
 
         return 0;
     }
+
+    // Read the whole file directly into the buffer, no intermediate copies
+    int getFileContents(const fspath& filename, ByteStream& fileContents)
+    {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            ErrorLog::getInstance().log("Unable to open file \"" + Utility::toUtf8String(filename) + "\"");
+            return 1;
+        }
+
+        const std::streamoff fileSize = file.tellg();
+        if (fileSize < 0) return 1;
+
+        fileContents.resize(fileSize);
+        file.seekg(0, std::ios::beg);
+        if (!file.read(fileContents.data(), fileSize))
+        {
+            ErrorLog::getInstance().log("Failed to read file \"" + Utility::toUtf8String(filename) + "\"");
+            return 1;
+        }
+
+        return 0;
+    }
 }
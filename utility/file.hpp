@@ -6,6 +6,7 @@
 #include <filesystem>
 
 #include <utility/path.hpp>
+#include <utility/buffer.hpp>
 
 #ifdef DEVKITPRO
     #include <sys/stat.h>
@@ -112,7 +113,14 @@ namespace Utility
 
     bool copy(const fspath& from, const fspath& to);
 
+    #ifndef DEVKITPRO
+        // Copies a single file without logging, uses reflinks/in-kernel copies where the OS has them
+        bool clone_file(const fspath& from, const fspath& to);
+    #endif
+
     int getFileContents(const fspath& filename, std::string& fileContents, bool resourceFile = false);
 
     int getFileContents(const fspath& filename, std::stringstream& fileContents);
+
+    int getFileContents(const fspath& filename, ByteStream& fileContents);
 }
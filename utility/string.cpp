@@ -53,4 +53,17 @@ namespace Utility::Str {
     {
         return str.find(substr) != std::string::npos;
     }
+
+    std::string bytesToHex(const std::string& bytes)
+    {
+        static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+        std::string ret;
+        ret.reserve(bytes.size() * 2);
+        for(const char& byte : bytes) {
+            ret += HEX_DIGITS[(byte >> 4) & 0xF];
+            ret += HEX_DIGITS[byte & 0xF];
+        }
+
+        return ret;
+    }
 }
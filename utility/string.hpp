@@ -68,6 +68,8 @@ namespace Utility::Str {
 
     bool contains(const std::string& str, const std::string& substr);
 
+    std::string bytesToHex(const std::string& bytes); //lowercase, 2 digits per byte
+
     //wrapper for a constexpr string, for use in other templates
     template<size_t N>
     struct StringLiteral {
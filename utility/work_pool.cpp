@@ -0,0 +1,162 @@
+#include "work_pool.hpp"
+
+#include <utility>
+
+
+
+namespace Utility {
+    WorkStealingPool::WorkStealingPool(const size_t& numThreads) {
+        const size_t count = numThreads > 0 ? numThreads : 1;
+
+        queues.reserve(count);
+        for(size_t i = 0; i < count; i++) {
+            queues.emplace_back(std::make_unique<Queue>());
+        }
+
+        // queues have to exist before any worker starts looking at them
+        threads.reserve(count);
+        for(size_t i = 0; i < count; i++) {
+            threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool() {
+        wait();
+
+        {
+            std::scoped_lock lock(stateMut);
+            stopping = true;
+        }
+        taskAvailable.notify_all();
+
+        for(std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    void WorkStealingPool::push(Task_t task) {
+        size_t index = getWorkerIndex();
+        if(index >= queues.size()) {
+            index = nextQueue++ % queues.size();
+        }
+
+        pending++;
+        {
+            std::scoped_lock lock(queues[index]->mut);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        queued++;
+
+        // take the lock so a worker can't miss the notification between checking queued and sleeping
+        {
+            std::scoped_lock lock(stateMut);
+        }
+        taskAvailable.notify_one();
+    }
+
+    void WorkStealingPool::wait() {
+        std::unique_lock lock(stateMut);
+        allDone.wait(lock, [this]() { return pending == 0; });
+    }
+
+    void WorkStealingPool::runAndWait(std::vector<Task_t>& tasks) {
+        struct Group {
+            std::vector<Task_t> tasks;
+            std::atomic<size_t> next = 0;
+            std::atomic<size_t> remaining = 0;
+        };
+
+        const auto runClaimed = [](Group& group) {
+            for(size_t i = group.next++; i < group.tasks.size(); i = group.next++) {
+                group.tasks[i]();
+                group.tasks[i] = nullptr;
+                if(--group.remaining == 0) group.remaining.notify_all();
+            }
+        };
+
+        // helpers can start after this returns, so they share ownership of the group
+        const std::shared_ptr<Group> group = std::make_shared<Group>();
+        group->remaining = tasks.size();
+        group->tasks = std::move(tasks);
+        tasks.clear();
+
+        for(size_t i = 1; i < group->tasks.size(); i++) {
+            push([group, runClaimed]() { runClaimed(*group); });
+        }
+
+        // this thread only runs tasks from the group, it may be holding locks that unrelated tasks need
+        runClaimed(*group);
+        for(size_t remaining = group->remaining; remaining > 0; remaining = group->remaining) {
+            group->remaining.wait(remaining);
+        }
+    }
+
+    size_t WorkStealingPool::getWorkerIndex() const {
+        const std::thread::id id = std::this_thread::get_id();
+        for(size_t i = 0; i < threads.size(); i++) {
+            if(threads[i].get_id() == id) return i;
+        }
+
+        return threads.size();
+    }
+
+    bool WorkStealingPool::tryPop(const size_t& index, Task_t& out) {
+        // own queue first, newest task
+        {
+            Queue& own = *queues[index];
+            std::scoped_lock lock(own.mut);
+            if(!own.tasks.empty()) {
+                out = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                queued--;
+                return true;
+            }
+        }
+
+        // steal the oldest task from someone else, that's usually the biggest remaining chunk of work
+        for(size_t offset = 1; offset < queues.size(); offset++) {
+            Queue& other = *queues[(index + offset) % queues.size()];
+            std::scoped_lock lock(other.mut);
+            if(!other.tasks.empty()) {
+                out = std::move(other.tasks.front());
+                other.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void WorkStealingPool::workerLoop(const size_t index) {
+        while(true) {
+            Task_t task;
+            if(tryPop(index, task)) {
+                task();
+                task = nullptr; // release anything the task captured before reporting it as done
+
+                if(--pending == 0) {
+                    std::scoped_lock lock(stateMut);
+                    allDone.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock lock(stateMut);
+            taskAvailable.wait(lock, [this]() { return stopping || queued > 0; });
+            if(stopping && queued == 0) return;
+        }
+    }
+
+    void runTasks(std::vector<WorkStealingPool::Task_t>& tasks, WorkStealingPool* pool) {
+        if(pool != nullptr) {
+            pool->runAndWait(tasks);
+            return;
+        }
+
+        for(WorkStealingPool::Task_t& task : tasks) {
+            task();
+        }
+        tasks.clear();
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+
+
+namespace Utility {
+    // Thread pool where each worker has its own task queue
+    // Tasks pushed from a worker go to that worker's queue and run newest-first (keeps a subtree's data in cache)
+    // Idle workers steal the oldest task from other queues, so one large branch doesn't leave the rest idle
+    class WorkStealingPool {
+    public:
+        using Task_t = std::function<void()>;
+
+        explicit WorkStealingPool(const size_t& numThreads);
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        void push(Task_t task);
+        void wait(); // blocks until every task has finished, including ones pushed by other tasks
+        void runAndWait(std::vector<Task_t>& tasks); // runs a group of tasks, free workers help with it, safe to call from a task
+        size_t getThreadCount() const { return threads.size(); }
+
+    private:
+        struct Queue {
+            std::mutex mut;
+            std::deque<Task_t> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> threads;
+
+        std::mutex stateMut;
+        std::condition_variable taskAvailable;
+        std::condition_variable allDone;
+        std::atomic<size_t> queued = 0; // tasks sitting in a queue
+        std::atomic<size_t> pending = 0; // queued + running
+        std::atomic<size_t> nextQueue = 0; // round robin for tasks pushed from outside the pool
+        bool stopping = false;
+
+        size_t getWorkerIndex() const; // returns threads.size() if not called from a worker
+        bool tryPop(const size_t& index, Task_t& out);
+        void workerLoop(const size_t index);
+    };
+
+    void runTasks(std::vector<WorkStealingPool::Task_t>& tasks, WorkStealingPool* pool); // runs them on the pool, or in order on this thread if pool is nullptr
+}